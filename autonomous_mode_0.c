@@ -3,22 +3,12 @@
 #include "ifi_utilities.h"
 #include "user_routines.h"
 #include "user_Serialdrv.h"
+#include "user_autoscript.h"
 /*This file has nothing it it. This is our do nothing autonomous program.
-Do not add stuff to this plz.
+Do not add stuff to this plz. All it does is keep the compressor going.
 */
-void User_Autonomous_Code_0(void)
+const rom unsigned char auto_script_0[] =
 {
-
-while (autonomous_mode)   /* DO NOT CHANGE! */
-  {
-    if (statusflag.NEW_SPI_DATA)      /* 26.2ms loop area */
-    {
-        Getdata(&rxdata);   /* DO NOT DELETE, or you will be stuck here forever! */
-		pressure_control();	//turn on compressor
-        /* Add your own autonomous code here. */
-        Generate_Pwms(pwm13,pwm14,pwm15,pwm16);
-//Add in the sperate autonomous files
-        Putdata(&txdata);   /* DO NOT DELETE, or you will get no PWM outputs! */
-    }
-  }
-}
+	AS_COMPRESSOR, 1,		//turn on compressor
+	AS_END
+};
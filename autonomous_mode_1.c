@@ -3,8 +3,14 @@
 #include "ifi_utilities.h"
 #include "user_routines.h"
 #include "user_Serialdrv.h"
+#include "user_encoder.h"
+#include "user_autoscript.h"
+#include "user_heading.h"
+#include "user_odometry.h"
+#include "user_frame.h"
+#include "user_input.h"
+#include "user_arena.h"
 #include <stdio.h>
-#include <string.h>
 
 /*This is used to show our status in the auto mode.*/
 typedef enum {START_UP,					//begins the autonoumous mode
@@ -15,81 +21,94 @@ typedef enum {START_UP,					//begins the autonoumous mode
 
 status_flags status = START_UP;			//renames statuss_flags as status and starts it as start up.
 
-/*this struct contains the information that we need to go on our journey*/
-struct info{
-	unsigned char left_speed;		//speed of left motor
-	unsigned char right_speed;		//speed of right motor
-	int left_journey[9];		//current count on left counter  (modified: J215, made an array different steps needed for different positions)
-                                // the values, btw, are completely bogus
-	int right_journey[9];		//current count on right counter (modified: J215, same as above only used for right)
-	char turn_flag;				//used to add turn data into striaght path 
-	char release_tetra;			//used to single time to release the tetra
-	char look_at;				//0 is right 1 is left
-}; 
-
-/*This table contains the information from above. Each array goes in order of how info is set up/ For example, the first
-line will set the left and right motors to 50 and will be that way until both counters are equal to 25.*/
-const rom struct info journey_step[] =
-{
-// 1/3 power is 45, right needs to be about 36 so 80% power
-//NEEDS INFO FOR TETRA FOUR ADDED	
-// GL = nearest loading station	 
-//l_drive, R_drive,  left tetra  1   2  3  4  5  6   7   8    GL  right tetra   1    2  3  4  5   6    7   8   GL  flags
-  {150,    150,                {20, 10, 0, 0, 10, 5, 504, 0,  20},             {20,  10, 0, 0, 10, 12, 504, 0, 20}, 0, 0, 0},
-  {160,    160,                {30, 10, 0, 0, 20, 5, 504, 0,  30},             {30,  10, 0, 0, 20, 12, 504, 0, 30}, 0, 0, 0},
-  {170,    170,                {40, 10, 0, 0, 50, 5, 504, 0,  40},             {40,  10, 0, 0, 50, 12, 504, 0, 40}, 0, 0, 0},
-  {160,    160,                {50, 10, 0, 0, 50, 5, 504, 0,  50},             {50,  10, 0, 0, 50, 12, 504, 0, 50}, 0, 0, 0},
-  {150,    150,                {62, 10, 0, 0, 50, 5, 504, 0,  62},             {62,  10, 0, 0, 50, 12, 504, 0, 62}, 0, 0, 0}, 
-
-  {127,    140,                {10, 10, 0, 0, 4, 5, 504, 0,  62},             {10,  10, 0, 0, 11, 12, 504, 0, 75}, 0, 0, 0}, 
-
-  {140,    140,                {10, 10, 0, 0, 4, 5, 504, 0,  69},             {10,  10, 0, 0, 11, 12, 504, 0, 82}, 0, 0, 0},
-  {145,    145,                {10, 10, 0, 0, 4, 5, 504, 0,  76},             {10,  10, 0, 0, 11, 12, 504, 0, 89}, 0, 0, 0},
-  {155,    155,                {10, 10, 0, 0, 4, 5, 504, 0,  83},             {10,  10, 0, 0, 11, 12, 504, 0, 96}, 0, 0, 0},
-  {127,    127,                {10, 10, 0, 0, 4, 5, 504, 0,  83},             {10,  10, 0, 0, 11, 12, 504, 0, 96}, 0, 0, 0},
-
+/*this struct points at the information that we need to go on our journey. The
+tables are laid out by column, so a step is just a few reads straight out of ROM
+and nothing has to be copied into RAM. Near rom pointers reach all 32K of flash.*/
+struct journey{
+	const rom unsigned char *left_speed;	//speed of left motor, one per step
+	const rom unsigned char *right_speed;	//speed of right motor, one per step
+	const rom unsigned char *look_at;		//0 is right 1 is left, one per step
+	const rom unsigned char *count[9];	//packed counts to drive to for each tetra, see next_count
 };
 
-/* This is where we keep the current step for memory purposes */
-volatile struct info current_step;
-
-/* Load step into work area */
-void load_step(unsigned char step_number)
+/*The journey tables, one per starting position, are made by tools/pathgen from
+the waypoints in tools/pathgen/paths.txt. Each step sets the left and right motors
+and they stay that way until the counter we are looking at reaches the count for
+our tetra. Don't edit journey_tables.h, change paths.txt and run make there.*/
+#include "journey_tables.h"
+
+static const rom struct journey *path;	//journey for our starting position
+static const rom unsigned char *count_pc;	//next byte of our tetra's counts
+static unsigned char count_run;			//steps left in a JOURNEY_RUN
+static int count_now;					//count for the step we are on
+
+/*Unpacks the count for the next step. Each byte is how much further the step goes
+than the one before, JOURNEY_RUN n is n steps that go no further and JOURNEY_BIG
+is followed by a 16 bit increase for a long step.*/
+static int next_count(void)
 {
-   memmovepgm2ram((void *)&current_step,
-	(void *)&journey_step[step_number],
-			sizeof(current_step));
+	if (count_run)
+		count_run--;
+	else if (count_pc[0] == JOURNEY_RUN)
+		{
+		count_run = count_pc[1] - 1;
+		count_pc += 2;
+		}
+	else if (count_pc[0] == JOURNEY_BIG)
+		{
+		count_now += ((int)count_pc[1] << 8) | (int)count_pc[2];
+		count_pc += 3;
+		}
+	else count_now += (int)*count_pc++;
+	return count_now;
 }
 
 static char step_now = 0;
 static unsigned int L_counter = 0;
 static unsigned int R_counter = 0;
 
-char r_we_there_yet(int left, char left_speed, int right, char right_speed, char position, char turn_flag, char step, char look_at);
-int camera_control(void);
+static void journey_count(void);
+char r_we_there_yet(int left, unsigned char left_speed, int right, unsigned char right_speed, char position, char step, char look_at);
 char get_position(void);
 
-void User_Autonomous_Code_1(void)
+/* Follow the journey table, then stop */
+const rom unsigned char auto_script_1[] =
+{
+	AS_COMPRESSOR, 1,		//this controls the compressor on the robot.
+	AS_JOURNEY,
+	AS_END
+};
+
+/* Called by AS_JOURNEY to start the journey from the first step */
+void Journey_Start(void)
+{
+	status = START_UP;
+	step_now = 0;
+	L_counter = 0;
+	R_counter = 0;
+}
+
+/* Called once every 26.2ms frame by AS_JOURNEY, returns 1 when the journey is done */
+unsigned char Journey_Step(void)
 {
 	static char position;
 	static char tetra;
 
-while (autonomous_mode)   /* DO NOT CHANGE! */
-  {
-    if (statusflag.NEW_SPI_DATA)      /* 26.2ms loop area */
-    {
-        Getdata(&rxdata);   /* DO NOT DELETE, or you will be stuck here forever! */
-        /* Add your own autonomous code here. */
-		pressure_control();		//this controls the compressor on the robot.
-
 		switch(status)			//determine the current status of the robot
 		{
 		case START_UP:			//if we are starting
-		//current_step = &current_step;	//set us up on the first leg of the journey
-		load_step(0);
         position = get_position();		
+		if (position < 0 || position > 5)
+			position = 3;
+		path = &journey_table[position];	//set us up on the first leg of the journey
 		tetra = camera_control();		//calls camera control, this function can be used to determine 
 								//what tetra we are going after.
+		if (tetra < 0 || tetra > 8)
+			tetra = 8;					//go for the loading station
+		count_pc = path->count[tetra];
+		count_run = 0;
+		count_now = 0;
+		next_count();
 		status = PRE_INITIALIZE;  	//now that we know what tetra we are going after, we start the journey
 		case PRE_INITIALIZE:		//if initialize
 		//this can be used to do anything that needs to be done before the journey begins.
@@ -99,74 +118,60 @@ while (autonomous_mode)   /* DO NOT CHANGE! */
 		status = CHECK_TO_SEE_IF_DONE;	//change status
 		break;
 		case CHECK_TO_SEE_IF_DONE:	//if CHECK_TO_SEE_IF_DONE
-				if(r_we_there_yet(current_step.left_journey[tetra],current_step.left_speed, current_step.right_journey[tetra],current_step.right_speed, position, current_step.turn_flag, step_now, current_step.look_at))
+				journey_count();		//how far the wheels went this frame
+				/* A step that is already done (the zero length padding rows) goes
+				straight on to the next one in this frame, so the last step's PWM
+				doesn't keep running while we look at it. The table always ends
+				with a stop row, so this can't run off the end. */
+				while(r_we_there_yet(count_now, path->left_speed[step_now], count_now, path->right_speed[step_now], position, step_now, path->look_at[step_now]))
                    {
-					if(current_step.left_speed == 127 && current_step.right_speed == 127)
+					if(path->left_speed[step_now] == 127 && path->right_speed[step_now] == 127)
 						{
 						status = COMPLETE;
 						set_drive_L(127);
 						set_drive_R(127);
-						printf("We are done\r");
+						break;
 						}
-					else {
-						step_now++;
-                        load_step(step_now);
-						printf("\r\r\r\r\rCurrently on part %d\r", (int)step_now);                    
-					    printf("left journey: %d left_speed: %d right journey: %d right speed: %d turn flag: %d\r",current_step.left_journey[tetra],
-                		current_step.left_speed, current_step.right_journey[tetra], current_step.right_speed, current_step.turn_flag); 
-						if(!current_step.look_at)
-							L_counter = R_counter;
-						else R_counter = L_counter; 
-						status = INITIALIZE;
-						 }	
+					step_now++;
+					next_count();
+					if(!path->look_at[step_now])
+						L_counter = R_counter;
+					else R_counter = L_counter; 
 					}
-				
-		
 			break;
 		case COMPLETE:
-		break;
+		return 1;
 		}
+	return 0;
+}
+
 
-        Generate_Pwms(pwm13,pwm14,pwm15,pwm16);
+/* add up how far each wheel went this frame, whichever way it turned */
+static void journey_count(void)
+{
+	if (encoders.left_rate < 0)
+		L_counter -= encoders.left_rate;
+	else L_counter += encoders.left_rate;
 
-        Putdata(&txdata);   /* DO NOT DELETE, or you will get no PWM outputs! */
-    }
-  }
+	if (encoders.right_rate < 0)
+		R_counter -= encoders.right_rate;
+	else R_counter += encoders.right_rate;
 }
 
+/*Drives the step, or returns 1 without driving if the counter we are looking at
+is already there. It doesn't add up the counters, so it can be called again for
+the next step in the same frame.*/
+/* The step we are on, for the JNY telemetry line */
+unsigned char Journey_Part(void)
+{
+	return (unsigned char)step_now;
+}
 
-char r_we_there_yet(int left, char left_speed, int right, char right_speed, char position, char turn_flag, char step, char look_at)
+char r_we_there_yet(int left, unsigned char left_speed, int right, unsigned char right_speed, char position, char step, char look_at)
 {
 	char chk = 0;
-	static char L_last_val;
-	static char R_last_val;
 
-	if (L_banner != L_last_val)
-		{
-		L_counter++;
-		L_last_val = L_banner;
-		}
-
-	if (R_banner != R_last_val)
-		{
-		R_counter++;
-		R_last_val = R_banner;
-		}
-				
 //printf("the left counter is %d, right counter is %d\r", L_counter, R_counter);
-	if(left_speed < 127)
-		drive_L = ((left_speed - 127) * motor_bal + 127);	//ensure we are not over 254								//sets right drive to speed
-	else drive_L = left_speed;					//set to highest speed
-
-
-	if(right_speed > 127)
-		drive_R = ((right_speed - 127) * motor_bal + 127);	//ensure we are not over 254								//sets right drive to speed
-	else drive_R = right_speed;					//set to highest speed
-
-//set_drive_L(left_speed);
-//set_drive_R(right_speed);
-printf("left and rights motor speeds %d %d\r", drive_L, drive_R);
-
 	if(look_at)
 		if (L_counter < left)
 			chk++;
@@ -175,17 +180,22 @@ printf("left and rights motor speeds %d %d\r", drive_L, drive_R);
 		if (R_counter < right)
 			chk++;
 
-if(turn_flag)
-	{
-	drive_L = 127;
-	drive_R = 127;
-	Pwm2_green = 1;
-	}
+	if (chk == 0)		//already there, don't drive a zero length step
+		return 1;
 
+	if(left_speed == right_speed)
+		Heading_Hold(left_speed);		//straight leg, let the heading hold keep us straight
+	else
+		{
+		Heading_Hold_Release();
+		set_drive_L(left_speed);
+		set_drive_R(right_speed);
+		}
+
+//set_drive_L(left_speed);
+//set_drive_R(right_speed);
 
-	if (chk != 0)
-		return 0;
-	else return 1;
+	return 0;
 }
 
 /************************camera_control*/
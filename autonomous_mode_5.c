@@ -3,26 +3,10 @@
 #include "ifi_utilities.h"
 #include "user_routines.h"
 #include "user_Serialdrv.h"
+#include "user_autoscript.h"
 
-void User_Autonomous_Code_5(void)
+/* Add your own autonomous script here. See user_autoscript.h */
+const rom unsigned char auto_script_5[] =
 {
-
-while (autonomous_mode)   /* DO NOT CHANGE! */
-  {
-    if (statusflag.NEW_SPI_DATA)      /* 26.2ms loop area */
-    {
-        Getdata(&rxdata);   /* DO NOT DELETE, or you will be stuck here forever! */
-
-        /* Add your own autonomous code here. */
-        Generate_Pwms(pwm13,pwm14,pwm15,pwm16);
-//Add in the sperate autonomous files
-        Putdata(&txdata);   /* DO NOT DELETE, or you will get no PWM outputs! */
-    }
-  }
-}
-#include "ifi_aliases.h"
-#include "ifi_default.h"
-#include "ifi_utilities.h"
-#include "user_routines.h"
-#include "user_Serialdrv.h"
-
+	AS_END
+};
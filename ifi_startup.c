@@ -11,6 +11,7 @@
 *******************************************************************************/
 
 #include "ifi_default.h"
+#include "user_stack.h"
 
 extern void Clear_Memory (void);
 extern void main (void);
@@ -48,6 +49,7 @@ void _startup (void)
 loop:
 
  	Clear_Memory();              
+  Stack_Paint();    /* for the high water mark, see user_stack.c */
   _do_cinit ();
   /* Call the user's main routine */
   main ();
@@ -0,0 +1,141 @@
+/*******************************************************************************
+* FILE NAME: journey_tables.h
+*
+* DESCRIPTION:
+*  Generated by tools/pathgen from tools/pathgen/paths.txt.  DO NOT EDIT,
+*  change the waypoints and run make in tools/pathgen instead.
+*  One set of step columns per start position (see get_position) and
+*  journey_table to find them, included only by autonomous_mode_1.c.
+*  Counts are cumulative wheel ticks, packed as one byte per step of
+*  increase with JOURNEY_RUN/JOURNEY_BIG escapes (see next_count).
+*  1.178 inches per tick, 16 ticks for a 90 degree pivot turn.
+*******************************************************************************/
+
+/* position 0, 16 steps */
+const rom unsigned char journey_left_pos0[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 104, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_right_pos0[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 150, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_look_pos0[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* position 1, 16 steps */
+const rom unsigned char journey_left_pos1[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 104, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_right_pos1[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 150, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_look_pos1[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* position 2, 16 steps */
+const rom unsigned char journey_left_pos2[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 150, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_right_pos2[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 104, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_look_pos2[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* position 3, 16 steps */
+const rom unsigned char journey_left_pos3[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 104, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_right_pos3[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 150, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_look_pos3[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* position 4, 16 steps */
+const rom unsigned char journey_left_pos4[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 104, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_right_pos4[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 150, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_look_pos4[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* position 5, 16 steps */
+const rom unsigned char journey_left_pos5[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 150, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_right_pos5[] =
+{
+  145, 153, 161, 170, 161, 153, 145, 104, 145, 153, 161, 170, 161, 153, 145, 127
+};
+const rom unsigned char journey_look_pos5[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* Count streams, 82 bytes (1728 as plain ints) */
+#define JOURNEY_RUN 254
+#define JOURNEY_BIG 255
+
+const rom unsigned char journey_counts_0[] =
+{
+  254, 16
+};
+const rom unsigned char journey_counts_1[] =
+{
+  8, 8, 8, 14, 8, 8, 8, 16, 5, 4, 4, 0, 4, 4, 4, 0
+};
+const rom unsigned char journey_counts_2[] =
+{
+  4, 4, 3, 0, 3, 3, 3, 16, 6, 5, 5, 0, 5, 5, 5, 0
+};
+const rom unsigned char journey_counts_3[] =
+{
+  2, 2, 2, 0, 2, 1, 1, 16, 4, 4, 3, 0, 3, 3, 3, 0
+};
+const rom unsigned char journey_counts_4[] =
+{
+  8, 8, 8, 3, 8, 8, 8, 16, 2, 2, 2, 0, 2, 2, 2, 0
+};
+const rom unsigned char journey_counts_5[] =
+{
+  5, 4, 4, 0, 4, 4, 4, 16, 2, 2, 2, 0, 2, 2, 2, 0
+};
+
+const rom struct journey journey_table[6] =
+{
+  {journey_left_pos0, journey_right_pos0, journey_look_pos0,
+   {journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_1}},
+  {journey_left_pos1, journey_right_pos1, journey_look_pos1,
+   {journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_1}},
+  {journey_left_pos2, journey_right_pos2, journey_look_pos2,
+   {journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_1}},
+  {journey_left_pos3, journey_right_pos3, journey_look_pos3,
+   {journey_counts_2, journey_counts_3, journey_counts_0, journey_counts_0, journey_counts_4, journey_counts_5, journey_counts_0, journey_counts_0, journey_counts_1}},
+  {journey_left_pos4, journey_right_pos4, journey_look_pos4,
+   {journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_1}},
+  {journey_left_pos5, journey_right_pos5, journey_look_pos5,
+   {journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_0, journey_counts_1}},
+};
@@ -6,15 +6,19 @@
 *
 * USAGE:
 *  You should not need to modify this file.
-*  Note the different loop speed for the two routines:
-*     Process_Data_From_Master_uP
-*     Process_Data_From_Local_IO
+*  Everything the main loop does is called from the task table in
+*  user_scheduler.c.  Note the different loop speeds in that table:
+*     Process_Data_From_Master_uP   every 26.2ms packet from the master uP
+*     Sample_Sensors                every 1ms
+*     Telemetry_Task                every 20ms
+*     Process_Data_From_Local_IO    every loop
 *******************************************************************************/
 
 #include "ifi_aliases.h"
 #include "ifi_default.h"
 #include "ifi_utilities.h"
 #include "user_routines.h"
+#include "user_scheduler.h"
 #include <stdio.h>
 
 tx_data_record txdata;          /* DO NOT CHANGE! */
@@ -45,18 +49,9 @@ void main (void)
     statusflag.NEW_SPI_DATA = 1;
 #endif
 
-    if (statusflag.NEW_SPI_DATA)      /* 26.2ms loop area */
-    {                                 /* I'm slow!  I only execute every 26.2ms because */
-                                      /* that's how fast the Master uP gives me data. */
-      Process_Data_From_Master_uP();  /* You edit this in user_routines.c */
-
-      if (autonomous_mode)            /* DO NOT CHANGE! */
-      {
-        User_Autonomous_Code();        /* You edit this in user_routines_fast.c */
-	  }
-    }
-    Process_Data_From_Local_IO();     /* You edit this in user_routines_fast.c */
-                                      /* I'm fast!  I execute during every loop.*/
+    Scheduler_Run();                  /* You edit the task table in user_scheduler.c */
+                                      /* The 26.2ms packet task runs User_Autonomous_Code */
+                                      /* one frame at a time when in autonomous mode. */
   } /* while (1) */
 }  /* END of Main */
 
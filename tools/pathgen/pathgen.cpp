@@ -0,0 +1,476 @@
+/*******************************************************************************
+* FILE NAME: pathgen.cpp
+*
+* DESCRIPTION:
+*  Host side path compiler for the autonomous journey tables.  Reads field
+*  waypoints and robot geometry from a text file (see paths.txt) and writes
+*  journey_tables.h, which autonomous_mode_1.c includes.  Every path is
+*  turned into pivot turns and straight legs, and every straight leg gets a
+*  trapezoid speed profile (ramp up, cruise, ramp down).
+*
+*  The journey table shares one set of speeds per row between all nine tetra
+*  columns, so all the paths for one start position have to be the same shape:
+*  the same number of legs and turns the same way.  Shorter paths are padded
+*  with zero length legs, which the firmware steps through without driving.
+*
+* USAGE:
+*  pathgen paths.txt ../../journey_tables.h
+*  "make" in this directory does that, and only when paths.txt changed.
+*******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kPositions = 6;         // get_position() codes 0-5
+const int kTetras = 9;            // tetra 1-8 and GL (nearest loading station)
+const double kPi = 3.14159265358979;
+
+// Count stream escapes, written into journey_tables.h for the decoder.
+const int kRun = 254;             // kRun, n: n steps that don't add anything
+const int kBig = 255;             // kBig, hi, lo: a step adding 254 or more
+
+struct Geometry
+{
+  double wheel_diameter = 6;      // inches
+  int banner_stripes = 8;         // both edges are counted
+  double track_width = 24;        // inches
+  double motor_bal = 0.80;        // factory drive gain (saved_profile)
+  double full_speed = 60;         // inches/s at PWM 254, unscaled side
+  int start_pwm = 145;            // first speed of a ramp
+  int cruise_pwm = 170;           // top speed of a straight leg
+  int ramp_steps = 3;             // rows on each side of the cruise row
+  int ramp_ticks = 8;             // ticks per ramp row
+  int turn_pwm = 150;             // forward wheel PWM in a pivot turn
+  double auto_time = 15;          // seconds in autonomous
+};
+
+struct Point
+{
+  double x;
+  double y;
+};
+
+// One turn or straight leg, in ticks of the wheel being watched.
+struct Leg
+{
+  bool turn;
+  int dir;                        // turns: +1 left (CCW), -1 right, 0 none
+  int ticks;
+};
+
+struct Row
+{
+  int left_speed;
+  int right_speed;
+  int count[kTetras];             // cumulative ticks, same for both wheels
+  int look_at;                    // 0 watches the right wheel, 1 the left
+};
+
+[[noreturn]] void Fail(const std::string& where, const std::string& what)
+{
+  std::fprintf(stderr, "pathgen: %s: %s\n", where.c_str(), what.c_str());
+  std::exit(1);
+}
+
+double InchesPerTick(const Geometry& g)
+{
+  return kPi * g.wheel_diameter / (2.0 * g.banner_stripes);
+}
+
+// Turns the waypoints of one path into legs.  The robot starts at the first
+// waypoint facing +x.
+std::vector<Leg> MakeLegs(const std::vector<Point>& pts, const Geometry& g)
+{
+  std::vector<Leg> legs;
+  double heading = 0;
+  double per_tick = InchesPerTick(g);
+
+  for (size_t i = 1; i < pts.size(); i++)
+  {
+    double dx = pts[i].x - pts[i - 1].x;
+    double dy = pts[i].y - pts[i - 1].y;
+    double want = std::atan2(dy, dx);
+    double turn = std::remainder(want - heading, 2 * kPi);
+    int turn_ticks = (int)std::lround(std::fabs(turn) * g.track_width / 2 / per_tick);
+
+    legs.push_back({true, turn_ticks ? (turn > 0 ? 1 : -1) : 0, turn_ticks});
+    legs.push_back({false, 0, (int)std::lround(std::hypot(dx, dy) / per_tick)});
+    heading = want;
+  }
+  return legs;
+}
+
+// Splits a straight leg over the 2 * ramp_steps + 1 rows of its trapezoid.
+std::vector<int> SplitLeg(int ticks, const Geometry& g)
+{
+  int ramps = 2 * g.ramp_steps;
+  std::vector<int> len(ramps + 1, 0);
+
+  if (ticks >= ramps * g.ramp_ticks)
+  {
+    for (int i = 0; i < ramps; i++)
+      len[i < g.ramp_steps ? i : i + 1] = g.ramp_ticks;
+    len[g.ramp_steps] = ticks - ramps * g.ramp_ticks;
+  }
+  else
+  {
+    // too short to reach cruise speed: share it out over the ramps
+    for (int i = 0; i < ramps; i++)
+      len[i < g.ramp_steps ? i : i + 1] = ticks / ramps + (i < ticks % ramps);
+  }
+  return len;
+}
+
+int RampSpeed(int step, const Geometry& g)
+{
+  return g.start_pwm + (g.cruise_pwm - g.start_pwm) * step / g.ramp_steps;
+}
+
+// Speed of the watched wheel in inches/s, after the factory drive gain.
+double WheelSpeed(const Row& r, const Geometry& g)
+{
+  int pwm = r.look_at ? r.left_speed : r.right_speed;
+  bool scaled = r.look_at ? (pwm < 127) : (pwm > 127);
+  double v = std::abs(pwm - 127) / 127.0 * g.full_speed;
+  return scaled ? v * g.motor_bal : v;
+}
+
+std::vector<Row> BuildTable(int pos, const std::vector<std::vector<Leg>>& paths,
+                            const Geometry& g)
+{
+  std::vector<Row> rows;
+  size_t legs = 0;
+  int cum[kTetras] = {0};
+
+  for (const auto& p : paths)
+    legs = std::max(legs, p.size());
+
+  for (size_t l = 0; l < legs; l++)
+  {
+    // zero length padding for paths that are already done
+    Leg leg[kTetras];
+    int dir = 0;
+    for (int t = 0; t < kTetras; t++)
+    {
+      leg[t] = l < paths[t].size() ? paths[t][l] : Leg{l % 2 == 0, 0, 0};
+      if (leg[t].dir != 0)
+      {
+        if (dir != 0 && dir != leg[t].dir)
+          Fail("position " + std::to_string(pos),
+               "leg " + std::to_string(l) + " turns left for one tetra and "
+               "right for another; split it into separate legs");
+        dir = leg[t].dir;
+      }
+    }
+
+    if (leg[0].turn)
+    {
+      if (dir == 0)
+        continue;                 // nobody turns here
+      Row r;
+      int back = 254 - g.turn_pwm;
+      r.left_speed = dir > 0 ? back : g.turn_pwm;
+      r.right_speed = dir > 0 ? g.turn_pwm : back;
+      r.look_at = dir > 0 ? 0 : 1;  // watch the wheel going forward
+      for (int t = 0; t < kTetras; t++)
+        r.count[t] = cum[t] += leg[t].ticks;
+      rows.push_back(r);
+      continue;
+    }
+
+    std::vector<std::vector<int>> split;
+    for (int t = 0; t < kTetras; t++)
+      split.push_back(SplitLeg(leg[t].ticks, g));
+
+    for (int s = 0; s <= 2 * g.ramp_steps; s++)
+    {
+      Row r;
+      int speed = s <= g.ramp_steps ? RampSpeed(s, g) : RampSpeed(2 * g.ramp_steps - s, g);
+      r.left_speed = r.right_speed = speed;
+      r.look_at = 0;
+      for (int t = 0; t < kTetras; t++)
+        r.count[t] = cum[t] += split[t][s];
+      rows.push_back(r);
+    }
+  }
+
+  Row stop;
+  stop.left_speed = stop.right_speed = 127;
+  stop.look_at = 0;
+  for (int t = 0; t < kTetras; t++)
+    stop.count[t] = cum[t];
+  rows.push_back(stop);
+
+  // Check each tetra fits in an int and in the autonomous period.
+  for (int t = 0; t < kTetras; t++)
+  {
+    double secs = 0;
+    int last = 0;
+    for (const auto& r : rows)
+    {
+      if (r.count[t] > 32767)
+        Fail("position " + std::to_string(pos), "count overflows an int");
+      if (r.count[t] > last)
+        secs += (r.count[t] - last) * InchesPerTick(g) / WheelSpeed(r, g);
+      last = r.count[t];
+    }
+    if (secs > g.auto_time)
+      Fail("position " + std::to_string(pos) + " tetra " + std::to_string(t + 1),
+           "path takes about " + std::to_string(secs) + "s");
+  }
+  return rows;
+}
+
+void WriteBytes(std::FILE* out, const std::vector<int>& bytes)
+{
+  for (size_t i = 0; i < bytes.size(); i++)
+    std::fprintf(out, "%s%d", i % 16 ? ", " : (i ? ",\n  " : "  "), bytes[i]);
+  std::fprintf(out, "\n};\n");
+}
+
+void WriteList(std::FILE* out, const std::vector<Row>& rows, int Row::*field)
+{
+  std::vector<int> bytes;
+  for (const auto& r : rows)
+    bytes.push_back(r.*field);
+  WriteBytes(out, bytes);
+}
+
+// Writes the speed and look_at columns of one position, a byte per step.
+void WriteTable(std::FILE* out, int pos, const std::vector<Row>& rows)
+{
+  std::fprintf(out, "/* position %d, %d steps */\n", pos, (int)rows.size());
+  std::fprintf(out, "const rom unsigned char journey_left_pos%d[] =\n{\n", pos);
+  WriteList(out, rows, &Row::left_speed);
+  std::fprintf(out, "const rom unsigned char journey_right_pos%d[] =\n{\n", pos);
+  WriteList(out, rows, &Row::right_speed);
+  std::fprintf(out, "const rom unsigned char journey_look_pos%d[] =\n{\n", pos);
+  WriteList(out, rows, &Row::look_at);
+  std::fprintf(out, "\n");
+}
+
+// Packs one tetra's cumulative counts as the step to step increase, one
+// byte each, with kRun for runs of steps that don't move the watched wheel
+// and kBig for the rare step longer than 253 ticks.
+std::vector<int> EncodeCounts(const std::vector<int>& counts)
+{
+  std::vector<int> out;
+  int last = 0;
+
+  for (size_t i = 0; i < counts.size(); i++)
+  {
+    int delta = counts[i] - last;
+    size_t run = 0;
+
+    while (i + run < counts.size() && counts[i + run] == last && run < 255)
+      run++;
+    if (run >= 3)
+    {
+      out.push_back(kRun);
+      out.push_back((int)run);
+      i += run - 1;
+      continue;
+    }
+
+    if (delta < 0)
+      Fail("counts", "journey counts must never go down");
+    if (delta >= kRun)
+    {
+      out.push_back(kBig);
+      out.push_back(delta >> 8);
+      out.push_back(delta & 255);
+    }
+    else out.push_back(delta);
+    last = counts[i];
+  }
+  return out;
+}
+
+// The same decoder the firmware runs, to prove the stream round trips.
+std::vector<int> DecodeCounts(const std::vector<int>& bytes, size_t steps)
+{
+  std::vector<int> out;
+  size_t pc = 0;
+  int run = 0;
+  int now = 0;
+
+  while (out.size() < steps)
+  {
+    if (run)
+      run--;
+    else if (bytes[pc] == kRun)
+    {
+      run = bytes[pc + 1] - 1;
+      pc += 2;
+    }
+    else if (bytes[pc] == kBig)
+    {
+      now += (bytes[pc + 1] << 8) | bytes[pc + 2];
+      pc += 3;
+    }
+    else now += bytes[pc++];
+    out.push_back(now);
+  }
+  return out;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc != 3)
+  {
+    std::fprintf(stderr, "usage: pathgen <paths.txt> <journey_tables.h>\n");
+    return 2;
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in)
+    Fail(argv[1], "can't open");
+
+  Geometry g;
+  std::vector<Point> pts[kPositions][kTetras];
+  std::string line;
+  int line_no = 0;
+
+  while (std::getline(in, line))
+  {
+    line_no++;
+    line = line.substr(0, line.find('#'));
+    std::istringstream ss(line);
+    std::string key;
+    std::string where = std::string(argv[1]) + ":" + std::to_string(line_no);
+    if (!(ss >> key))
+      continue;
+
+    if (key == "path")
+    {
+      int pos, tetra;
+      char comma;
+      Point p;
+      if (!(ss >> pos >> tetra) || pos < 0 || pos >= kPositions || tetra < 1 || tetra > kTetras)
+        Fail(where, "expected: path <position 0-5> <tetra 1-9> x,y ...");
+      auto& path = pts[pos][tetra - 1];
+      if (!path.empty())
+        Fail(where, "path given twice");
+      path.push_back({0, 0});
+      while (ss >> p.x >> comma >> p.y)
+      {
+        if (comma != ',')
+          Fail(where, "waypoints are x,y");
+        path.push_back(p);
+      }
+      if (!ss.eof())
+        Fail(where, "bad waypoint");
+      continue;
+    }
+
+    double v;
+    if (!(ss >> v))
+      Fail(where, "missing value for " + key);
+    if (key == "wheel_diameter") g.wheel_diameter = v;
+    else if (key == "banner_stripes") g.banner_stripes = (int)v;
+    else if (key == "track_width") g.track_width = v;
+    else if (key == "motor_bal") g.motor_bal = v;
+    else if (key == "full_speed") g.full_speed = v;
+    else if (key == "start_pwm") g.start_pwm = (int)v;
+    else if (key == "cruise_pwm") g.cruise_pwm = (int)v;
+    else if (key == "ramp_steps") g.ramp_steps = (int)v;
+    else if (key == "ramp_ticks") g.ramp_ticks = (int)v;
+    else if (key == "turn_pwm") g.turn_pwm = (int)v;
+    else if (key == "auto_time") g.auto_time = v;
+    else Fail(where, "unknown setting " + key);
+  }
+
+  if (g.ramp_steps < 1 || g.start_pwm <= 127 || g.cruise_pwm > 254 ||
+      g.turn_pwm <= 127 || g.turn_pwm > 254)
+    Fail(argv[1], "speeds must be forward PWMs (128-254) and ramp_steps >= 1");
+
+  std::FILE* out = std::fopen(argv[2], "w");
+  if (!out)
+    Fail(argv[2], "can't write");
+
+  std::fprintf(out,
+    "/*******************************************************************************\n"
+    "* FILE NAME: journey_tables.h\n"
+    "*\n"
+    "* DESCRIPTION:\n"
+    "*  Generated by tools/pathgen from tools/pathgen/paths.txt.  DO NOT EDIT,\n"
+    "*  change the waypoints and run make in tools/pathgen instead.\n"
+    "*  One set of step columns per start position (see get_position) and\n"
+    "*  journey_table to find them, included only by autonomous_mode_1.c.\n"
+    "*  Counts are cumulative wheel ticks, packed as one byte per step of\n"
+    "*  increase with JOURNEY_RUN/JOURNEY_BIG escapes (see next_count).\n"
+    "*  %.3f inches per tick, %d ticks for a 90 degree pivot turn.\n"
+    "*******************************************************************************/\n\n",
+    InchesPerTick(g),
+    (int)std::lround((kPi / 2) * g.track_width / 2 / InchesPerTick(g)));
+
+  int stream_of[kPositions][kTetras];
+  std::map<std::vector<int>, int> stream_ids;   // identical streams are shared
+  std::vector<const std::vector<int>*> streams;
+  size_t packed = 0;
+  int total_steps = 0;
+
+  for (int pos = 0; pos < kPositions; pos++)
+  {
+    std::vector<std::vector<Leg>> paths;
+    for (int t = 0; t < kTetras; t++)
+      paths.push_back(MakeLegs(pts[pos][t], g));
+    std::vector<Row> rows = BuildTable(pos, paths, g);
+    if (rows.size() > 127)        // step_now is a char
+      Fail("position " + std::to_string(pos), "more than 127 steps");
+    total_steps += (int)rows.size();
+    WriteTable(out, pos, rows);
+
+    for (int t = 0; t < kTetras; t++)
+    {
+      std::vector<int> counts;
+      for (const auto& r : rows)
+        counts.push_back(r.count[t]);
+      std::vector<int> bytes = EncodeCounts(counts);
+      if (DecodeCounts(bytes, counts.size()) != counts)
+        Fail("position " + std::to_string(pos), "count encoder doesn't round trip");
+      auto it = stream_ids.emplace(bytes, (int)streams.size()).first;
+      if (it->second == (int)streams.size())
+      {
+        streams.push_back(&it->first);
+        packed += bytes.size();
+      }
+      stream_of[pos][t] = it->second;
+    }
+  }
+
+  std::fprintf(out, "/* Count streams, %d bytes (%d as plain ints) */\n",
+               (int)packed, 2 * kTetras * total_steps);
+  std::fprintf(out, "#define JOURNEY_RUN %d\n#define JOURNEY_BIG %d\n\n", kRun, kBig);
+  for (size_t i = 0; i < streams.size(); i++)
+  {
+    std::fprintf(out, "const rom unsigned char journey_counts_%d[] =\n{\n", (int)i);
+    WriteBytes(out, *streams[i]);
+  }
+  std::fprintf(out, "\n");
+
+  std::fprintf(out, "const rom struct journey journey_table[%d] =\n{\n", kPositions);
+  for (int pos = 0; pos < kPositions; pos++)
+  {
+    std::fprintf(out, "  {journey_left_pos%d, journey_right_pos%d, journey_look_pos%d,\n   {",
+                 pos, pos, pos);
+    for (int t = 0; t < kTetras; t++)
+      std::fprintf(out, "%sjourney_counts_%d", t ? ", " : "", stream_of[pos][t]);
+    std::fprintf(out, "}},\n");
+  }
+  std::fprintf(out, "};\n");
+
+  std::fclose(out);
+  return 0;
+}
@@ -16,9 +16,10 @@
 *
 * ASSUMPTION AND LIMITATIONS:
 *  A printf call now can be buffered by setting the USE_BUFFERED_PRINTF to one.  This
-*  enables the user to write non-blocking application code.  However, if two consecutive 
-*  printfs are invoked, the second will be blocked until the first is complete. This
-*  can be resolved by adding a circular queue to the device status structure.
+*  enables the user to write non-blocking application code.  Each port queues up to
+*  POOL_BLOCKS blocks behind the one being sent, so consecutive printfs only wait
+*  when every block in the pool is taken.  Serial_Write_Bufr, which sends the
+*  caller's own buffer, still waits until the port is idle.
 *  
 *
 * USAGE:
@@ -30,6 +31,7 @@
 #include <stdio.h>
 
 #include "user_Serialdrv.h"
+#include "user_pool.h"
 #include "ifi_default.h"
 #include "delays.h"
 
@@ -44,21 +46,35 @@ typedef struct
   unsigned char portId;
   unsigned char wtCount;
   unsigned char *wtbufr;
-  unsigned char wtBufr[MAX_WT_BUFR_SIZE];
-  unsigned char wtBufrIdx;
+  unsigned char wtBlock;      /* pool block being sent, freed when done */
+  unsigned char wtQBlock[POOL_BLOCKS];  /* pool blocks waiting their turn */
+  unsigned char wtQLen[POOL_BLOCKS];    /* and their lengths */
+  unsigned char wtQHead;      /* next to send */
+  unsigned char wtQCount;     /* how many are waiting */
+  unsigned char wtFill;       /* pool block printf is filling */
+  unsigned char wtBufrIdx;    /* bytes in wtFill */
   volatile near unsigned char *myRCREG;
   volatile near unsigned char *myTXREG;
 } DeviceStatus;
 
 typedef DeviceStatus *DeviceStatusPtr;
 
-static char rom2ramBufr[MAX_RD_BUFR_SIZE];  
 static PANEL_INPUT_RECORD  dataIn;     /* data input buffer (from Breaker Panel) */
+static PANEL_INPUT_RECORD  panelIn;    /* last whole packet, set in the interrupt */
+static PANEL_INPUT_RECORD  panelFrame; /* panelIn as of the start of this frame */
 static unsigned char IntState;    
 
 static DeviceStatus dcb[TOTAL_SERIAL_PORTS];  /* device control block */
+
+static void Serial_Send(int port,unsigned char *ch_out, sword16 len, unsigned char block);
 unsigned char aBreakerWasTripped;
 
+volatile UART_ERRORS uart_errors[TOTAL_SERIAL_PORTS];
+volatile unsigned char cam_rx_dropped = 0;
+static unsigned char cam_rx_ring[CAM_RX_RING];   /* camera bytes not parsed yet */
+static volatile unsigned char cam_rx_head = 0;   /* next free, interrupt only */
+static volatile unsigned char cam_rx_tail = 0;   /* next to parse, main loop only */
+
 /*******************************************************************************
 * FUNCTION NAME: Reset_Control_Block
 * PURPOSE:       Handles incomming data from PROGRAM_PORT and/or TTL_PORT.  It
@@ -74,6 +90,17 @@ static void Reset_Control_Block(DeviceStatusPtr dcbPtr)
 {
   INTCONbits.PEIE = 0;          /* Disable peripheral interrupt */
   dcbPtr->wtCount = 0;
+  Pool_Free(dcbPtr->wtBlock);
+  Pool_Free(dcbPtr->wtFill);
+  while (dcbPtr->wtQCount)
+  {
+    Pool_Free(dcbPtr->wtQBlock[dcbPtr->wtQHead]);
+    dcbPtr->wtQHead = (dcbPtr->wtQHead + 1) % POOL_BLOCKS;
+    dcbPtr->wtQCount--;
+  }
+  dcbPtr->wtQHead = 0;
+  dcbPtr->wtBlock = POOL_NONE;
+  dcbPtr->wtFill = POOL_NONE;
   dcbPtr->wtBufrIdx = 0;
   INTCONbits.PEIE = 1;          /* Enable peripheral interrupts */
 }
@@ -179,7 +206,7 @@ static void CheckTXIntFlag(int port)
 /*******************************************************************************
 * FUNCTION NAME: Serial_Resume_Port
 * PURPOSE:       Used to reenable a port that has been terminated due to an error.
-* CALLED FROM:   N/A
+* CALLED FROM:   Rx_Error_Check
 * ARGUMENTS:     1
 *     Argument       Type             IO   Description
 *     --------       -------------    --   -----------
@@ -204,6 +231,73 @@ void Serial_Resume_Port(int port)
   }
 }
 
+/*******************************************************************************
+* FUNCTION NAME: Rx_Error_Check
+* PURPOSE:       Counts receive errors and gets the port going again.  A byte
+*                with a framing error is read and thrown away.  After an
+*                overrun the UART receives nothing until CREN is cleared, so
+*                that is done here, in the same interrupt.
+* CALLED FROM:   CheckUartInts, Camera_Rx_Fast
+* ARGUMENTS:     1
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     port           Int              I    TTL_PORT or PROGRAM_PORT
+* RETURNS:       1 if there was an error, and no byte to read now
+*******************************************************************************/
+
+static unsigned char Rx_Error_Check(int port)
+{
+  unsigned char ferr, oerr, flush;
+
+  if (port == PROGRAM_PORT)
+  {
+    ferr = RCSTA1bits.FERR;
+    oerr = RCSTA1bits.OERR;
+  }
+  else
+  {
+    ferr = RCSTA2bits.FERR;
+    oerr = RCSTA2bits.OERR;
+  }
+
+  if (ferr)
+  {
+    uart_errors[port].framing++;
+    flush = *dcb[port].myRCREG;   /* reading it clears FERR */
+  }
+  if (oerr)
+  {
+    uart_errors[port].overruns++;
+    Serial_Resume_Port(port);
+    if (port == PROGRAM_PORT ? !RCSTA1bits.OERR : !RCSTA2bits.OERR)
+      uart_errors[port].recoveries++;
+  }
+  return ferr | oerr;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Serial_Error_Byte
+* PURPOSE:       Packs the error counts into one byte for the OI.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       high nibble TTL_PORT (camera), low nibble PROGRAM_PORT
+*                (breaker panel), overruns plus framing errors, stops at 15
+*******************************************************************************/
+
+unsigned char Serial_Error_Byte(void)
+{
+  unsigned int prog, ttl;
+
+  INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+  prog = uart_errors[PROGRAM_PORT].overruns + uart_errors[PROGRAM_PORT].framing;
+  ttl = uart_errors[TTL_PORT].overruns + uart_errors[TTL_PORT].framing;
+  INTCONbits.PEIE = 1;          /* Enable low priority interrupts */
+
+  if (prog > 15) prog = 15;
+  if (ttl > 15) ttl = 15;
+  return (unsigned char)((ttl << 4) | prog);
+}
+
 /*******************************************************************************
 ***********************  Interrupt Routines  ***********************************
 *******************************************************************************/
@@ -234,7 +328,9 @@ void DisableXmitInts(DeviceStatusPtr dcbPtr)
 
 /*******************************************************************************
 * FUNCTION NAME: Process_TX
-* PURPOSE:       Transmits an output buffer to the serial port.
+* PURPOSE:       Transmits an output buffer to the serial port.  When it's
+*                done, gives its block back and starts on the next one in
+*                the queue.
 * CALLED FROM:   CheckUartInts
 * ARGUMENTS:     1
 *     Argument       Type             IO   Description
@@ -244,10 +340,20 @@ void DisableXmitInts(DeviceStatusPtr dcbPtr)
 
 static void Process_TX(DeviceStatusPtr dcbPtr)
 {
-  if (dcbPtr->wtCount == 0)     /* if all data is transmitted, then disable TX */
+  if (dcbPtr->wtCount == 0)
   {
-    DisableXmitInts(dcbPtr);
-    return;
+    Pool_Free(dcbPtr->wtBlock);   /* give its buffer back */
+    dcbPtr->wtBlock = POOL_NONE;
+    if (dcbPtr->wtQCount == 0)    /* if all data is transmitted, then disable TX */
+    {
+      DisableXmitInts(dcbPtr);
+      return;
+    }
+    dcbPtr->wtBlock = dcbPtr->wtQBlock[dcbPtr->wtQHead];
+    dcbPtr->wtCount = dcbPtr->wtQLen[dcbPtr->wtQHead];
+    dcbPtr->wtbufr = Pool_Ptr(dcbPtr->wtBlock);
+    dcbPtr->wtQHead = (dcbPtr->wtQHead + 1) % POOL_BLOCKS;
+    dcbPtr->wtQCount--;
   }
   *dcbPtr->myTXREG = *dcbPtr->wtbufr++;  /* Load transmit register with data */
   dcbPtr->wtCount--;                     /* advance bufr counter */
@@ -284,23 +390,19 @@ void Handle_Panel_Data(unsigned char data)
       break;
     case 2 : //get DATA1
       dataIn.data1Byte.allbits = data;
-      txdata.user_byte3 = data;
-      aBreakerWasTripped = (int) dataIn.data1Byte.bitselect.tripped;
       IntState = 3;
       break;
     case 3 : //get DATA2
       dataIn.data2 = data;
-      txdata.user_byte4 = data;
       IntState = 4;
       break;
     case 4 : //get DATA3
       dataIn.data3 = data;
-      txdata.user_byte5 = data;
       IntState = 5;
       break;
     case 5 : //get DATA4
       dataIn.data4 = data;
-      txdata.user_byte6 = data;
+      panelIn = dataIn;         /* whole packet, Panel_Latch picks it up */
       IntState = 0;
       break;
     default:
@@ -322,6 +424,11 @@ void CheckUartInts ()
   if (RXINTF)       
   { 
     RXINTF = 0;
+    if (Rx_Error_Check(BREAKER_PANEL_PORT))
+    {
+      IntState = 0;           /* start looking for the next packet */
+      return;
+    }
     Handle_Panel_Data(*dcb[BREAKER_PANEL_PORT].myRCREG);
     return;
   }
@@ -330,7 +437,12 @@ void CheckUartInts ()
 
   if (RXINTF2)       
   { 
+#if CAMERA_RX_FAST_LANE
+    Camera_Rx_Fast();   /* normally already taken in InterruptHandlerLow */
+#else
     RXINTF2 = 0;
+    if (Rx_Error_Check(TTL_PORT))
+      return;
     /* If you want to handle RX data on the program port, you could provide a
        callback routine to parse data.
 
@@ -341,6 +453,7 @@ void CheckUartInts ()
        You must supply the body of this routine in a file of your choice.  
     */
     Serial_Char_Callback(*dcb[TTL_PORT].myRCREG);
+#endif
     return;
   }
   if (TXINTF2)      //data is being transferred one byte at a time
@@ -366,8 +479,9 @@ void Serial_Driver_Initialize(void)
 
 /*******************************************************************************
 * FUNCTION NAME: Serial_Write_Bufr
-* PURPOSE:       Writes a buffer to the specified serial port.  
-* CALLED FROM:   Serial_Write or any application layer routine
+* PURPOSE:       Writes a buffer to the specified serial port.  The buffer
+*                must not change until it has been sent.
+* CALLED FROM:   any application layer routine
 * ARGUMENTS:     3
 *     Argument       Type             IO   Description
 *     --------       -------------    --   -----------
@@ -377,18 +491,78 @@ void Serial_Driver_Initialize(void)
 *******************************************************************************/
 
 void Serial_Write_Bufr(int port,unsigned char *ch_out, sword16 len) 
+{
+  Serial_Send(port, ch_out, len, POOL_NONE);
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Serial_Send
+* PURPOSE:       Starts sending a buffer, or if the port is busy puts a pool
+*                block in its queue.  A pool block never waits here, the
+*                queue has room for every block in the pool.  The caller's
+*                own buffer (POOL_NONE) waits until the port is idle.
+* CALLED FROM:   Serial_Write_Bufr, Serial_Write, Serial_Display_Char
+* ARGUMENTS:     4
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     port           int              I    TTL_PORT or PROGRAM_PORT
+*     ch_out         unsigned char *  I    output buffer
+*     len            sword16          I    number of bytes to transmit
+*     block          unsigned char    I    pool block ch_out is in, given
+*                                          back when it's sent, or POOL_NONE
+*******************************************************************************/
+
+static void Serial_Send(int port,unsigned char *ch_out, sword16 len, unsigned char block) 
 {
   static DeviceStatusPtr dcbPtr;
 
   dcbPtr = &dcb[port];
 
+  if (len <= 0)
+  {
+    Pool_Free(block);
+    return;
+  }
+
+  /* the caller's buffer: wait till done writing, and the queue is empty */
+  if (block == POOL_NONE)
+    while (dcbPtr->wtCount > 0 || dcbPtr->wtBlock != POOL_NONE ||
+           dcbPtr->wtQCount > 0);
+
   INTCONbits.PEIE = 0;    //Disable peripheral interrupt
-  dcbPtr->wtbufr = ch_out;
-  dcbPtr->wtCount = (unsigned char) len;
+  if (dcbPtr->wtCount > 0 || dcbPtr->wtBlock != POOL_NONE || dcbPtr->wtQCount > 0)
+  {
+    /* busy, Process_TX starts it when its turn comes */
+    dcbPtr->wtQBlock[(dcbPtr->wtQHead + dcbPtr->wtQCount) % POOL_BLOCKS] = block;
+    dcbPtr->wtQLen[(dcbPtr->wtQHead + dcbPtr->wtQCount) % POOL_BLOCKS] = (unsigned char) len;
+    dcbPtr->wtQCount++;
+  }
+  else
+  {
+    dcbPtr->wtbufr = ch_out;
+    dcbPtr->wtBlock = block;
+    dcbPtr->wtCount = (unsigned char) len;
+  }
   INTCONbits.PEIE = 1;    //Enable peripheral interrupt
   CheckTXIntFlag(port);
 }
 
+/*******************************************************************************
+* FUNCTION NAME: Serial_Block
+* PURPOSE:       Takes a block from the pool, waiting for the transmit
+*                interrupt to give one back if they are all being sent.
+*                Not from the interrupt, which it would be waiting on.
+* CALLED FROM:   Serial_Write, Serial_Display_Char
+* ARGUMENTS:     none
+* RETURNS:       the block
+*******************************************************************************/
+
+static unsigned char Serial_Block(void)
+{
+  while (pool_in_use >= POOL_BLOCKS);
+  return Pool_Alloc();
+}
+
 /*******************************************************************************
 * FUNCTION NAME: Serial_Write
 * PURPOSE:       Prepares a data buffer to be written to a serial port. 
@@ -403,14 +577,38 @@ void Serial_Write_Bufr(int port,unsigned char *ch_out, sword16 len)
 
 unsigned char Serial_Write(int port,rom const char *obufr,sword16 len)
 {
-  while (dcb[port].wtCount > 0);  /* wait till done writing */
+  unsigned char block;
 
-  if (len > MAX_WT_BUFR_SIZE) len = MAX_WT_BUFR_SIZE;
-  strcpypgm2ram(rom2ramBufr,(rom char *) obufr);
-  Serial_Write_Bufr(port,(unsigned char *)rom2ramBufr,len);
+  block = Serial_Block();
+  if (block == POOL_NONE)
+    return 1;                     /* counted in pool_failures */
+
+  if (len > POOL_BLOCK_SIZE) len = POOL_BLOCK_SIZE;
+  strncpypgm2ram((char *)Pool_Ptr(block),(rom char *) obufr,len);
+  Serial_Send(port,Pool_Ptr(block),len,block);
   return 0;
 }
 
+/*******************************************************************************
+* FUNCTION NAME: Serial_Busy
+* PURPOSE:       Tells if a port is still sending, or has blocks queued.
+* CALLED FROM:   User application layer
+* ARGUMENTS:     1
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     port           int              I    TTL_PORT or PROGRAM_PORT
+* RETURNS:       1 if it is, 0 if a write would start right away
+*******************************************************************************/
+
+unsigned char Serial_Busy(int port)
+{
+  static DeviceStatusPtr dcbPtr;
+
+  dcbPtr = &dcb[port];
+  return dcbPtr->wtCount > 0 || dcbPtr->wtBlock != POOL_NONE ||
+         dcbPtr->wtQCount > 0;
+}
+
 /*******************************************************************************
 * FUNCTION NAME: Serial_Write_Char
 * PURPOSE:       Write a byte to a specified serial port. 
@@ -438,8 +636,10 @@ void Serial_Write_Char(int port,int ch_out)
 
 /*******************************************************************************
 * FUNCTION NAME: Serial_Display_Char
-* PURPOSE:       Buffers data until a '\r' is seen or MAX_WT_BUFR_SIZE is reached.
-*                Once either condition is met, the transmission is started.
+* PURPOSE:       Buffers data until a '\r' is seen or POOL_BLOCK_SIZE is reached.
+*                Once either condition is met, the block is queued for the
+*                transmitter and the next character goes in a new block, so
+*                printf only waits when the whole pool is queued.
 * CALLED FROM:   User application layer (Write_Byte_To_Uart)
 * ARGUMENTS:     1
 *     Argument       Type             IO   Description
@@ -449,18 +649,92 @@ void Serial_Write_Char(int port,int ch_out)
 
 void Serial_Display_Char(unsigned char data)
 {
-  while (dcb[PRINTF_PORT].wtCount > 0);  /* wait till done writing */
+  static DeviceStatusPtr dcbPtr;
+
+  dcbPtr = &dcb[PRINTF_PORT];
+
+  if (dcbPtr->wtFill == POOL_NONE)
+  {
+    dcbPtr->wtFill = Serial_Block();
+    if (dcbPtr->wtFill == POOL_NONE)
+      return;                     /* dropped, counted in pool_failures */
+    dcbPtr->wtBufrIdx = 0;
+  }
+
+  Pool_Ptr(dcbPtr->wtFill)[dcbPtr->wtBufrIdx++] = data;
+  if ((data == '\r') || (dcbPtr->wtBufrIdx >= POOL_BLOCK_SIZE) )
+  {
+    Serial_Send(PRINTF_PORT,Pool_Ptr(dcbPtr->wtFill),dcbPtr->wtBufrIdx,dcbPtr->wtFill);
+    dcbPtr->wtFill = POOL_NONE;
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Camera_Rx_Fast
+* PURPOSE:       Empties the TTL_PORT receive FIFO into cam_rx_ring.  At
+*                115200 baud a byte comes every 87us and the FIFO only holds
+*                two, so this is kept to just the copy.
+* CALLED FROM:   InterruptHandlerLow, first
+* ARGUMENTS:     none
+*******************************************************************************/
+void Camera_Rx_Fast(void)
+{
+  unsigned char next;
+  unsigned char data;
 
-  dcb[PRINTF_PORT].wtBufr[dcb[PRINTF_PORT].wtBufrIdx++] = data;
-  if ((data == '\r') || (dcb[PRINTF_PORT].wtBufrIdx >= MAX_WT_BUFR_SIZE) )
+  while (RXINTF2)             /* clears when the FIFO is empty */
   {
-    INTCONbits.PEIE = 0;    //Disable peripheral interrupt
-    dcb[PRINTF_PORT].wtbufr = &dcb[PRINTF_PORT].wtBufr[0];
-    dcb[PRINTF_PORT].wtCount = dcb[PRINTF_PORT].wtBufrIdx;
-    INTCONbits.PEIE = 1;    //Enable peripheral interrupt
-    dcb[PRINTF_PORT].wtBufrIdx = 0;
-    CheckTXIntFlag(PRINTF_PORT);
+    if ((RCSTA2bits.FERR || RCSTA2bits.OERR) && Rx_Error_Check(TTL_PORT))
+      continue;
+    data = RCREG2;
+    next = (cam_rx_head + 1) & (CAM_RX_RING - 1);
+    if (next == cam_rx_tail)
+      cam_rx_dropped++;
+    else
+    {
+      cam_rx_ring[cam_rx_head] = data;
+      cam_rx_head = next;
+    }
   }
+  if (RCSTA2bits.OERR)
+    Rx_Error_Check(TTL_PORT);
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Camera_Rx_Drain
+* PURPOSE:       Parses the camera bytes the interrupt has queued.
+* CALLED FROM:   user_routines_fast.c, Process_Data_From_Local_IO;
+*                user_camera.c, wait_for_data
+* ARGUMENTS:     none
+*******************************************************************************/
+void Camera_Rx_Drain(void)
+{
+  while (cam_rx_tail != cam_rx_head)
+  {
+    Serial_Char_Callback(cam_rx_ring[cam_rx_tail]);
+    cam_rx_tail = (cam_rx_tail + 1) & (CAM_RX_RING - 1);
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Panel_Latch
+* PURPOSE:       Takes the last whole breaker panel packet for this frame,
+*                so Breaker_Tripped and the OI see one packet, not bytes
+*                from two.
+* CALLED FROM:   user_frame.c, Frame_Latch
+* ARGUMENTS:     none
+*******************************************************************************/
+void Panel_Latch(void)
+{
+  INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+  panelFrame = panelIn;
+  INTCONbits.PEIE = 1;          /* Enable low priority interrupts */
+
+  txdata.user_byte3 = panelFrame.data1Byte.allbits;
+  txdata.user_byte4 = panelFrame.data2;
+  txdata.user_byte5 = panelFrame.data3;
+  txdata.user_byte6 = panelFrame.data4;
+  aBreakerWasTripped = (int) panelFrame.data1Byte.bitselect.tripped;
 }
 
 /*******************************************************************************
@@ -486,22 +760,22 @@ unsigned char Breaker_Tripped(unsigned char id)
   if (id < 9)         //Check breakers 1-8
   {
     bit2check = 1 << (id - 1);
-    retn = dataIn.data4 & bit2check;
+    retn = panelFrame.data4 & bit2check;
   }
   else if (id < 17)   //Check breakers 9-16
   {
     bit2check = 1 << (id - 9);
-    retn = dataIn.data3 & bit2check;
+    retn = panelFrame.data3 & bit2check;
   }
   else if (id < 25)   //Check breakers 17-24
   {
     bit2check = 1 << (id - 17);
-    retn = dataIn.data2 & bit2check;
+    retn = panelFrame.data2 & bit2check;
   }
   else                //Check breakers 25-28
   {
     bit2check = 1 << (id - 25);
-    retn = dataIn.data1Byte.allbits & bit2check;
+    retn = panelFrame.data1Byte.allbits & bit2check;
   }
   return retn;
 }
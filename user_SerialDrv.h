@@ -33,8 +33,17 @@ typedef unsigned int   uint32;
 #define PRINTF_PORT         PROGRAM_PORT
 #define BREAKER_PANEL_PORT  PROGRAM_PORT
 
-#define MAX_RD_BUFR_SIZE    32    
-#define MAX_WT_BUFR_SIZE    80    
+// Camera (TTL_PORT) receive.  1 = the low priority interrupt checks it
+// before anything else and only moves the bytes into cam_rx_ring, the
+// camera parser runs from the main loop.  0 = the old way, parsed in
+// CheckUartInts after everything else; keep it to compare the overruns.
+#define CAMERA_RX_FAST_LANE 1
+#define CAM_RX_RING         32    // power of 2
+
+// Transmit buffers are borrowed from the pool in user_pool.c, a printf
+// line is sent POOL_BLOCK_SIZE characters at a time.  Each port queues the
+// blocks behind the one being sent, so a printf only waits for the
+// transmitter when the whole pool is queued.
 
 #define RXINTF              PIR1bits.RCIF
 #define RXINTE              PIE1bits.RCIE
@@ -93,6 +102,16 @@ typedef struct
   unsigned char  data4;
 } PANEL_INPUT_RECORD;
 
+/*******************************************************************************
+* Receive errors on one port, counted by CheckUartInts and Camera_Rx_Fast.
+*******************************************************************************/
+typedef struct
+{
+  unsigned int  overruns;     //OERR, the 2 byte FIFO filled up
+  unsigned int  framing;      //FERR, a byte with a bad stop bit, thrown away
+  unsigned int  recoveries;   //times reception was restarted after an OERR
+} UART_ERRORS;
+
 
 /*******************************************************************************
                            FUNCTION PROTOTYPES
@@ -104,8 +123,16 @@ void Serial_Write_Char(int port,int ch_out);
 void Serial_Display_Char(unsigned char data);
 void Serial_Write_Bufr(int port,unsigned char *ch_out, sword16 len); 
 unsigned char Serial_Write(int port,rom const char *obufr,sword16 len);
+unsigned char Serial_Busy(int port);
 void Serial_Char_Callback(unsigned char data);
 unsigned char Breaker_Tripped(unsigned char id);
+void Panel_Latch(void);
+void Camera_Rx_Fast(void);
+void Camera_Rx_Drain(void);
+unsigned char Serial_Error_Byte(void);
+
+extern volatile UART_ERRORS uart_errors[TOTAL_SERIAL_PORTS];
+extern volatile unsigned char cam_rx_dropped;   /* cam_rx_ring was full */
 
 
 #endif
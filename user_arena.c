@@ -0,0 +1,77 @@
+/*******************************************************************************
+* FILE NAME: user_arena.c
+*
+* DESCRIPTION:
+*  This file contains the state that every control frame goes through: the
+*  encoder snapshot, the pose, the frame inputs and relays, the switch edges,
+*  and the working variables of the heading hold, lift profile and shoulder
+*  PID.  They used to be spread over whatever banks the linker picked, so
+*  Default_Routine and the routines it calls were switching banks (MOVLB)
+*  between nearly every pair of them.  Now they are all in "hot", which the
+*  HOT_STATE section puts in a bank of its own, so one MOVLB covers them.
+*
+*  The camera tracking grid and the other things only looked at now and then
+*  are left where they were.
+*
+* USAGE:
+*  Clear_Memory in ifi_startup.c zeroes all of RAM at reset, so everything
+*  in hot starts at 0, the same as the "= 0" initializers it replaced.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_frame.h"
+#include "user_input.h"
+#include "user_arena.h"
+
+#pragma udata HOT_STATE
+struct hot_state hot;
+#pragma udata
+
+#if ARENA_PROFILE
+unsigned int arena_profile_cycles;
+unsigned int arena_profile_max;
+
+/*******************************************************************************
+* FUNCTION NAME: Arena_Profile_Start
+* PURPOSE:       Starts Timer1 from 0, counting instruction cycles.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Arena_Profile_Start(void)
+{
+  T1CON = 0;                /* 1:1 prescale, internal clock, 16 bit reads */
+  T1CONbits.RD16 = 1;
+  TMR1H = 0;
+  TMR1L = 0;
+  PIR1bits.TMR1IF = 0;
+  T1CONbits.TMR1ON = 1;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Arena_Profile_Stop
+* PURPOSE:       Stops Timer1 and keeps the count.  Anything over 65535
+*                cycles (6.5ms) reads as 65535.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Arena_Profile_Stop(void)
+{
+  unsigned char lo;
+
+  T1CONbits.TMR1ON = 0;
+  lo = TMR1L;               /* reading TMR1L latches TMR1H */
+  if (PIR1bits.TMR1IF)
+    arena_profile_cycles = 0xFFFF;
+  else
+    arena_profile_cycles = ((unsigned int)TMR1H << 8) | lo;
+  if (arena_profile_cycles > arena_profile_max)
+    arena_profile_max = arena_profile_cycles;
+}
+#endif
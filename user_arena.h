@@ -0,0 +1,88 @@
+/*******************************************************************************
+* FILE NAME: user_arena.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_arena.c
+*  It contains the state every control frame reads and writes, gathered
+*  into one struct, and aliases so the code can keep using the old names.
+*
+* USAGE:
+*  Include this after user_encoder.h, user_odometry.h, user_frame.h and
+*  user_input.h.  The names below (encoders, pose, frame_in, in_now, ...)
+*  are fields of "hot" now, so nothing else may be declared with them.
+*  Anything added here has to fit in the hotbank in 18f8520user.lkr (64
+*  bytes, 63 used), or the link fails.  Grow the hotbank and shrink gpr1
+*  to match if it has to.
+*
+*  Set ARENA_PROFILE to 1 to time Default_Routine with Timer1.  The count
+*  is in instruction cycles and shows up in the telemetry.
+*******************************************************************************/
+#ifndef __user_arena_h_
+#define __user_arena_h_
+
+#define ARENA_PROFILE 0
+
+struct hot_state
+{
+  /* user_encoder.c */
+  ENCODER_SNAPSHOT encoders;
+
+  /* user_odometry.c */
+  ODO_POSE pose;
+
+  /* user_frame.c */
+  struct frame_inputs frame_in;
+  struct frame_outputs frame_out;
+  unsigned char frame_steps;
+
+  /* user_input.c */
+  unsigned char in_now[IN_BYTES];
+  unsigned char in_rise[IN_BYTES];
+  unsigned char in_fall[IN_BYTES];
+
+  /* user_heading.c, the heading hold */
+  unsigned char hold_engaged;
+  int hold_mark_L;
+  int hold_mark_R;
+  int hold_integral;
+
+  /* user_lift.c, the preset profile */
+  unsigned char lift_moving;
+  unsigned char lift_preset;
+  int lift_target;
+  int lift_ref;
+  int lift_vel;
+
+  /* user_shoulder.c, the PID */
+  unsigned char sh_started;
+  unsigned int sh_last;
+  long sh_integral;
+  int sh_out;
+};
+
+extern struct hot_state hot;
+
+#define encoders      hot.encoders
+#define pose          hot.pose
+#define frame_in      hot.frame_in
+#define frame_out     hot.frame_out
+#define frame_steps   hot.frame_steps
+#define in_now        hot.in_now
+#define in_rise       hot.in_rise
+#define in_fall       hot.in_fall
+
+#if ARENA_PROFILE
+extern unsigned int arena_profile_cycles;     /* Default_Routine, last frame */
+extern unsigned int arena_profile_max;        /* longest since power up */
+#endif
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_arena.c */
+#if ARENA_PROFILE
+void Arena_Profile_Start(void);
+void Arena_Profile_Stop(void);
+#endif
+
+#endif
@@ -0,0 +1,241 @@
+/*******************************************************************************
+* FILE NAME: user_autoscript.c
+*
+* DESCRIPTION:
+*  This file contains the interpreter for the autonomous scripts.  Every
+*  autonomous mode is now just a few bytes of const rom data (see
+*  user_autoscript.h for the instruction set) and this one routine runs them,
+*  so adding a mode is adding a table, not another copy of the control loop.
+*
+*  Autoscript_Step is called once per 26.2ms frame.  Instructions that only
+*  set something (AS_SET_DRIVE, AS_JUMP, ...) run back to back in the same
+*  frame; the first instruction that has to wait for something ends the
+*  frame and is checked again next frame.
+*
+* USAGE:
+*  User_Autonomous_Init picks a script with Autoscript_Start and
+*  User_Autonomous_Code calls Autoscript_Step.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_encoder.h"
+#include "user_scheduler.h"
+#include "user_autoscript.h"
+#include "user_heading.h"
+#include "user_lift.h"
+#include "user_shoulder.h"
+#include "user_frame.h"
+#include "user_odometry.h"
+#include "user_input.h"
+#include "user_arena.h"
+
+#define AS_HANDS_OFF  255   /* drive latch value: someone else drives */
+
+static const rom unsigned char *as_script;  /* script being run */
+static unsigned char as_ip;         /* offset of the current instruction */
+static unsigned char as_result;     /* set by AS_CAM_PROBE */
+static struct
+{
+  unsigned int  busy:1;             /* current instruction has been set up */
+  unsigned int  run_compressor:1;   /* run pressure_control every frame */
+  unsigned int  :6;
+} as_flags;
+#define as_busy       as_flags.busy
+#define as_compressor as_flags.run_compressor
+static unsigned char as_drive_L;    /* drive PWMs sent every frame */
+static unsigned char as_drive_R;
+static unsigned char as_lift;       /* lift_operate input sent every frame */
+static int as_mark_L;               /* wheel counts when AS_DRIVE started */
+static int as_mark_R;
+static unsigned int as_wait_until;  /* scheduler tick AS_WAIT ends on */
+
+/* 16 bit argument, high byte first, n bytes after the opcode */
+#define AS_ARG16(n) (((unsigned int)as_script[as_ip + (n)] << 8) | \
+                     (unsigned int)as_script[as_ip + (n) + 1])
+
+/*******************************************************************************
+* FUNCTION NAME: Autoscript_Start
+* PURPOSE:       Starts a script from the top with everything at neutral.
+* CALLED FROM:   user_routines_fast.c, User_Autonomous_Init
+* ARGUMENTS:
+*     Argument       Type                         IO   Description
+*     --------       -------------                --   -----------
+*     script         const rom unsigned char *    I    script to run
+* RETURNS:       void
+*******************************************************************************/
+void Autoscript_Start(const rom unsigned char *script)
+{
+  as_script = script;
+  as_ip = 0;
+  as_busy = 0;
+  as_result = 0;
+  as_compressor = 0;
+  as_drive_L = as_drive_R = 127;
+  as_lift = 127;
+  Lift_Stop();
+  Shoulder_Reset();
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Autoscript_Step
+* PURPOSE:       Runs one frame of the current script and sends the outputs.
+* CALLED FROM:   user_routines_fast.c, User_Autonomous_Code
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Autoscript_Step(void)
+{
+  unsigned char ops;
+  unsigned char wait = 0;
+  int left;
+  int right;
+
+  for (ops = 0; ops < AS_OPS_PER_FRAME && !wait; ops++)
+  {
+    switch (as_script[as_ip])
+    {
+      case AS_SET_DRIVE:
+        as_drive_L = as_script[as_ip + 1];
+        as_drive_R = as_script[as_ip + 2];
+        as_ip += 3;
+        break;
+
+      case AS_DRIVE:
+        if (!as_busy)
+        {
+          as_busy = 1;
+          as_mark_L = encoders.left;
+          as_mark_R = encoders.right;
+          as_drive_L = as_script[as_ip + 1];
+          as_drive_R = as_script[as_ip + 2];
+        }
+        left = encoders.left - as_mark_L;
+        right = encoders.right - as_mark_R;
+        if (left < 0) left = -left;
+        if (right < 0) right = -right;
+        if (left >= (int)AS_ARG16(3) || right >= (int)AS_ARG16(3))
+        {
+          as_busy = 0;
+          as_drive_L = as_drive_R = 127;
+          as_ip += 5;
+        }
+        else wait = 1;
+        break;
+
+      case AS_SET_LIFT:
+        as_lift = as_script[as_ip + 1];
+        Lift_Stop();
+        as_ip += 2;
+        break;
+
+      case AS_LIFT_TO:
+        as_lift = 127;
+        Lift_Go_To(as_script[as_ip + 1]);
+        as_ip += 2;
+        break;
+
+      case AS_WAIT_LIFT:
+        if (as_busy && !Lift_Moving() && lift == 127)   /* stopped last frame */
+        {
+          as_busy = 0;
+          as_ip += 1;
+        }
+        else
+        {
+          as_busy = 1;
+          wait = 1;
+        }
+        break;
+
+      case AS_SHOULDER_UP:
+        if (Shoulder_Position() < AS_ARG16(1))
+        {
+          shoulder = shoulder_speed_up;
+          wait = 1;
+        }
+        else
+        {
+          shoulder = 127;
+          as_ip += 3;
+        }
+        break;
+
+      case AS_WAIT:
+        if (!as_busy)
+        {
+          as_busy = 1;
+          as_wait_until = Scheduler_Get_Ticks() + AS_ARG16(1);
+        }
+        if ((int)(Scheduler_Get_Ticks() - as_wait_until) >= 0)
+        {
+          as_busy = 0;
+          as_ip += 3;
+        }
+        else wait = 1;
+        break;
+
+      case AS_COMPRESSOR:
+        as_compressor = (as_script[as_ip + 1] != 0);
+        if (!as_compressor)
+          compressor = 0;
+        as_ip += 2;
+        break;
+
+      case AS_CAM_PROBE:
+        as_result = (unsigned char)camera_control();
+        as_ip += 1;
+        break;
+
+      case AS_IF_RESULT:
+        if (as_result == as_script[as_ip + 1])
+          as_ip = as_script[as_ip + 2];
+        else as_ip += 3;
+        break;
+
+      case AS_JUMP:
+        as_ip = as_script[as_ip + 1];
+        break;
+
+      case AS_JOURNEY:
+        if (!as_busy)
+        {
+          as_busy = 1;
+          as_drive_L = as_drive_R = AS_HANDS_OFF;
+          Journey_Start();
+        }
+        if (Journey_Step())
+        {
+          as_busy = 0;
+          as_drive_L = as_drive_R = 127;
+          as_ip += 1;
+        }
+        else wait = 1;
+        break;
+
+      case AS_END:
+      default:                /* a bad opcode stops the robot */
+        as_drive_L = as_drive_R = 127;
+        as_lift = 127;
+        Lift_Stop();
+        wait = 1;
+        break;
+    }
+  }
+
+  if (as_drive_L == as_drive_R && as_drive_L != AS_HANDS_OFF)
+    Heading_Hold(as_drive_L);         /* straight, so hold the heading */
+  else if (as_drive_L != AS_HANDS_OFF)
+  {
+    Heading_Hold_Release();
+    set_drive_L(as_drive_L);
+    set_drive_R(as_drive_R);
+  }
+  if (Lift_Moving())
+    Lift_Run();
+  else lift_operate(as_lift);
+  if (as_compressor)
+    pressure_control();
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+* FILE NAME: user_autoscript.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_autoscript.c
+*  It contains the opcodes for the autonomous scripts and the scripts
+*  themselves, which live in autonomous_mode_0.c through autonomous_mode_5.c.
+*
+* USAGE:
+*  A script is a const rom unsigned char array.  Each instruction is an
+*  opcode followed by its argument bytes.  16 bit arguments are written with
+*  AS_U16() so they come out high byte first.  Jump addresses are byte
+*  offsets from the start of the script, so a script can be up to 255 bytes.
+*
+*  Opcode          Arguments            What it does
+*  ------          ---------            ------------
+*  AS_END          -                    stop the drive and lift, hold there
+*  AS_SET_DRIVE    left, right          set the drive PWMs and keep going
+*  AS_DRIVE        left, right, U16     drive until either wheel has gone
+*                                       that many ticks
+*  AS_SET_LIFT     input                lift_operate(input) every frame
+*  AS_LIFT_TO      preset               move the lift to a preset height,
+*                                       LIFT_PRESET_... in user_lift.h
+*  AS_WAIT_LIFT    -                    wait until the lift is stopped by a
+*                                       limit switch or gets to its preset
+*  AS_SHOULDER_UP  U16                  raise the shoulder until the pot
+*                                       reads at least this much
+*  AS_WAIT         U16                  wait this many milliseconds
+*  AS_COMPRESSOR   on                   run pressure_control every frame
+*  AS_CAM_PROBE    -                    result = camera_control()
+*  AS_IF_RESULT    value, addr          jump to addr if result == value
+*  AS_JUMP         addr                 jump to addr
+*  AS_JOURNEY      -                    follow the journey_step table in
+*                                       autonomous_mode_1.c until it's done
+*******************************************************************************/
+#ifndef __user_autoscript_h_
+#define __user_autoscript_h_
+
+#define AS_END          0
+#define AS_SET_DRIVE    1
+#define AS_DRIVE        2
+#define AS_SET_LIFT     3
+#define AS_WAIT_LIFT    4
+#define AS_SHOULDER_UP  5
+#define AS_WAIT         6
+#define AS_COMPRESSOR   7
+#define AS_CAM_PROBE    8
+#define AS_IF_RESULT    9
+#define AS_JUMP         10
+#define AS_JOURNEY      11
+#define AS_LIFT_TO      12
+
+#define AS_U16(v)       (unsigned char)((v) >> 8), (unsigned char)(v)
+
+/* Most instructions that don't wait that will be run in one frame */
+#define AS_OPS_PER_FRAME  8
+
+/* The scripts, one per autonomous mode */
+extern const rom unsigned char auto_script_0[];   //do nothing
+extern const rom unsigned char auto_script_1[];   //vision tetra to center goal
+extern const rom unsigned char auto_script_2[];   //vision tetra to side goal
+extern const rom unsigned char auto_script_3[];   //cap alliance center, hit hanging
+extern const rom unsigned char auto_script_4[];   //opponents side with tetra
+extern const rom unsigned char auto_script_5[];   //auto loading station
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_autoscript.c */
+void Autoscript_Start(const rom unsigned char *script);
+void Autoscript_Step(void);
+
+/* These routines reside in autonomous_mode_1.c */
+void Journey_Start(void);
+unsigned char Journey_Step(void);
+unsigned char Journey_Part(void);
+int camera_control(void);
+
+#endif
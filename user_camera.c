@@ -12,13 +12,16 @@ DESCRIPTION:
 LIMITATION:
   Sometimes, after pressing the reset button, the camera will not come up correctly.  If you 
   power cycle the camera when it is stuck - it will work correctly.  It seems to always work
-  from an RC power up.
+  from an RC power up.  Camera_Link_Task (user_camlink.c) now notices when it's stuck and
+  resets it again, and again, until it answers.
 
 ******************************************************************************************************/
 #include <stdio.h>
 #include <string.h>
 #include "user_Serialdrv.h"
 #include "user_camera.h"
+#include "user_camlink.h"
+#include "user_scheduler.h"
 #include "user_routines.h"
 #include "ifi_default.h"
 
@@ -33,10 +36,7 @@ LIMITATION:
 extern struct mhs166_profile volatile_profile;
 
 #if _USE_CMU_CAMERA
-extern unsigned int parse_mode;
-extern volatile unsigned int cam_index_ptr;
-extern volatile unsigned int data_rdy;
-unsigned char cam_uart_buffer[64]; 
+unsigned char cam_uart_buffer[MAX_BUF_SIZE];
 
 /**********************************************************************
 camera_getACK
@@ -51,20 +51,26 @@ commands.
 **********************************************************************/
 int camera_getACK(void)
 {
-  int cnt,i;
   Serial_Write(CAMERA_PORT,"\r",1);
   reset_rx_buffer();
-  if( wait_for_data()==0) return 0;
+  if( wait_for_data()==0)
+  {
+    Camera_Link_Activity(0);	//no answer at all, see user_camlink.c
+    return 0;
+  }
   if(cam_uart_buffer[0]==65) 
   {
     reset_rx_buffer();
+    Camera_Link_Activity(1);
     return 1;
   }
   if(cam_uart_buffer[0]==84) 
   {
+    Camera_Link_Activity(1);
     return 2;
   }
   reset_rx_buffer();
+  Camera_Link_Activity(0);	//NCK or garbage
   return 0;
   
 }
@@ -84,8 +90,8 @@ a buffer, you must use camera_buffer_cmd.  See camera_find_color for examples.
 **********************************************************************/
 int camera_const_cmd(rom const char *cmd_str)
 {
-  int i;
-  int len;
+  unsigned char i;
+  unsigned char len;
   for (i=0; i<MAX_BUF_SIZE; i++ )
   {
     if (cmd_str[i]=='\r' || cmd_str[i]==0 )
@@ -113,8 +119,8 @@ camera_const_cmd's twin, but is used for arrays that you make yourself.
 **********************************************************************/
 int camera_buffer_cmd(unsigned char *cmd_str)
 {
-  int i;
-  int len;
+  unsigned char i;
+  unsigned char len;
   for(i=0; i<MAX_BUF_SIZE; i++ )
   {
     if(cmd_str[i]=='\r' || cmd_str[i]==0 )
@@ -155,12 +161,15 @@ time is just long enough to catch ACKs from messages.
 **********************************************************************/
 int wait_for_data(void)
 {
-  int i;
+  unsigned int i;
 
   // This loop below is a counter that gives just enough time to catch
   // an ACK from a normal command.  
   for(i=0; i<20000; i++ )     
+  {
+	  Camera_Rx_Drain();		//bytes the interrupt has queued
 	  if(data_rdy!=0 ) return 1;
+  }
 	
   return 0;}
 
@@ -175,84 +184,13 @@ checks to see if the camera is responding.
 **********************************************************************/
 int camera_reset(void)
 {
-  int i;
   parse_mode=0;
   Serial_Write(CAMERA_PORT,"rs\r",3);
-  i=camera_getACK();
+  camera_getACK();
   return camera_getACK();
 }
 
 
-//
-// This routine initializes the camera. It first resets the
-// camera (so that it is in a known state). After that, we send
-// a configuration commands to the camera so that it is setup
-// for the specific use we intend to make of it.
-//
-void initialize_camera_window(void) {
-
-#if MHS_DEBUG
-   printf("initialize_camera_window()\r");
-#endif
-   camera_reset();
-   if (!camera_const_cmd("BM 1")) { /* Keep frame, once captured */
-#if MHS_DEBUG
-	  printf("BM 1 command failed\r");
-#endif
-	  return;
-   }
-   if (!camera_const_cmd("PM 1")) {   /* Enable poll mode */
-#if MHS_DEBUG
-	  printf("PM 1 command failed\r");
-#endif
-	  return;
-   }
-   if (!camera_const_cmd("RM 1")) {   /* Enable raw mode */
-#if MHS_DEBUG
-	  printf("RM 1 command failed\r");
-#endif
-	  return;
-   }
-   if (!camera_const_cmd("NF 6")) {   /* Noise filter to level 6 */
-#if MHS_DEBUG
-	  printf("NF 6 command failed\r");
-#endif
-	  return;
-   }
-   if (!camera_const_cmd("CR 0 32")) {   /* Set AGC to MID level */
-#if MHS_DEBUG
-	  printf("CR 0 32 command failed\r");
-#endif
-	  return;
-   }
-   if (!camera_const_cmd("CR 18 0")) {   /* Set into yCrCb instead of RGB  */
-#if MHS_DEBUG
-	  printf("CR 18 0 command failed\r");
-#endif
-	  return;
-   }
-   if (!camera_const_cmd("SO 0 1")) {   /* Servo 0 setup  */
-#if MHS_DEBUG
-	  printf("SO 0 1 command failed\r");
-#endif
-	  return;
-   }
-#if MHS_DEBUG
-   if (!camera_const_cmd("GW")) {   /* Get window size */
-	  printf("GW command failed\r");
-	  return;
-   }
-   if (!camera_const_cmd("VW 1 1 150 150")) {   /* Get window size */
-	  printf("VW 1 1 150 150 command failed\r");
-	  return;
-   }
-   dump_uart_buffer();
-#endif
-   wait_for_data();
-   reset_rx_buffer();
-   return;
-}
-
 /* Grab camera window for later processing */
 void grab_camera_window(void) {
 
@@ -524,13 +462,14 @@ int examine_grid_position(unsigned char x_pos, unsigned char y_pos, unsigned cha
 // This routine allows you to sequentially examine all positions in the
 // grid. The routine keeps a eye on if we have received something from
 // the master processor. If not, it keeps going. This allows us to cover
-// more than one cell per call.
+// more than one cell per call.  While the control frames are running late
+// (sched_shed, see user_scheduler.c) it doesn't look at any.
 //
 extern packed_struct statusflag;
 int examine_next_gp(void) {
 
     /* Enter loop to process as many cells as possible */
-    while (!statusflag.NEW_SPI_DATA) {
+    while (!statusflag.NEW_SPI_DATA && sched_shed < SCHED_SHED_CAMERA) {
     
         /* Advance to next slot, break out here if we are done */
         if (cam_next_slot >= cam_total_slots) {
@@ -678,11 +617,15 @@ unsigned char avec[8];      // Actual tetra vector
 //
 int probe_pos(unsigned char spos, unsigned int apos, unsigned char *resvec) {
 
-	static int plooper;          // Keeps track of where we are in vtetra array
+	static unsigned char plooper; // Keeps track of where we are in vtetra array
     unsigned int npos;           // Contents of current position in vtetra array
-    int tetras_found;            // Tetras found in this scan
-	static int sleep_count;      // Times we need to sleep
+	static unsigned char sleep_count; // Times we need to sleep
 	
+	// If the camera dropped out, Camera_Link_Task is bringing it back; this
+	// probe is lost, start it over once the camera is up again
+	if (pro_state != PRO_DONE && !Camera_Link_Ready())
+		pro_state = PRO_INIT;
+
 	// Dispatch based on our current probe state
 	switch (pro_state) {
 
@@ -693,11 +636,12 @@ int probe_pos(unsigned char spos, unsigned int apos, unsigned char *resvec) {
 		// Initialize our loop variable
 		plooper = 0;
 
-		// Get camera initialized
+		// Camera_Link_Task brings the camera up in the background
+		if (!Camera_Link_Ready())
+			return (0);
 #if MHS_DEBUG
 		printf("INIT\r");
 #endif
-		initialize_camera_window();
 		set_camera_grid(26, 26);
 
 		// Clean up actual tetra vector; overload "npos" for loop variable
@@ -759,7 +703,7 @@ int probe_pos(unsigned char spos, unsigned int apos, unsigned char *resvec) {
 #if MHS_DEBUG
 		printf("SCAN\r");
 #endif
-	    while (!statusflag.NEW_SPI_DATA) {
+	    while (!statusflag.NEW_SPI_DATA && sched_shed < SCHED_SHED_CAMERA) {
 
 			// If we're at the end of the table, get out now
 			if ((npos = vtetras[plooper++]) == CEND) {
@@ -795,7 +739,8 @@ int probe_pos(unsigned char spos, unsigned int apos, unsigned char *resvec) {
 			}
 		}
 
-		// Back to caller if there is a packet from master processor
+		// Back to caller if there is a packet from master processor, or the
+		// frames are running late
 		if (pro_state == PRO_SCAN)
 			return (0);
 
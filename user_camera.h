@@ -23,11 +23,26 @@
 */
 typedef struct
 {
-  unsigned int  x,y;
-  unsigned int  x1,y1,x2,y2;
-  unsigned int  size,conf,pan_servo,tilt_servo;
+  unsigned char x,y;          /* every field of a raw mode T packet is a byte */
+  unsigned char x1,y1,x2,y2;
+  unsigned char size,conf,pan_servo,tilt_servo;
 } cam_struct;
 
+/* Receive state shared by Serial_Char_Callback and the camera commands */
+typedef struct
+{
+  unsigned int  data_rdy:1;   /* a whole packet is in cam_uart_buffer */
+  unsigned int  parse_mode:1; /* 0 = '\r' lines (ACKs), 1 = T packets */
+  unsigned int  :6;
+} cam_flagbits;
+
+extern volatile cam_flagbits cam_flags;
+extern volatile unsigned char cam_index_ptr;  /* next free byte of cam_uart_buffer */
+extern unsigned char cam_uart_buffer[];
+
+#define data_rdy    cam_flags.data_rdy
+#define parse_mode  cam_flags.parse_mode
+
 
 /* 
 	These commands can be used by the user to control the camera.
@@ -56,7 +71,6 @@ void write_int_to_buffer(unsigned char *buf, int val );
 void test_if_tetra_seen(void);
 void identify_tetra_color(void);
 void grab_camera_window(void);
-void initialize_camera_window(void);
 void set_camera_grid(unsigned int x_count, unsigned int y_count);
 int examine_grid_position(unsigned char x_pos, unsigned char y_pos, unsigned char show);
 int examine_next_gp(void);
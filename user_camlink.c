@@ -0,0 +1,298 @@
+/*******************************************************************************
+* FILE NAME: user_camlink.c
+*
+* DESCRIPTION:
+*  This file contains the camera bring-up as a scheduler task.  It used to be
+*  initialize_camera_window: camera_reset and then a camera_const_cmd for
+*  each setting, every one of them spinning in wait_for_data until the ACK
+*  came back, so one call could hold up the main loop for most of a second.
+*
+*  Camera_Link_Task sends one command, returns, and looks for the ACK the
+*  next time it's called.  The main loop keeps running in between, so the
+*  master uP packets are answered the whole time the camera is coming up.
+*  It starts on its own once the camera has had CAM_LINK_POWERUP_MS to boot,
+*  which is after User_Proc_Is_Ready since no task runs before that.
+*
+*  Once the camera is up the task keeps an eye on it.  camera_getACK tells
+*  it about every command anything else sends (Camera_Link_Activity), and if
+*  the camera has been quiet for CAM_LINK_PING_MS the task sends one of the
+*  setup commands again itself, so a camera that reset on its own gets its
+*  settings back too.  No ACK to the ping, a NCK or garbage, or
+*  CAM_LINK_MISSES misses in a row from the other commands, and the camera
+*  is counted as failed and the whole reset and setup is run again after
+*  CAM_LINK_RETRY_MS, for as long as it takes.  That is the fix the note in
+*  user_camera.c asks for a power cycle for, as near as we can get to one
+*  without a relay on the camera's power.
+*
+* USAGE:
+*  Camera_Link_Task is in the scheduler table.  The bytes from the camera
+*  are parsed by Camera_Rx_Drain in Process_Data_From_Local_IO, the same as
+*  for the blocking commands, so this needs parse_mode 0.
+*******************************************************************************/
+
+#include <string.h>
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_Serialdrv.h"
+#include "user_scheduler.h"
+#include "user_camera.h"
+#include "user_camlink.h"
+
+#if _USE_CMU_CAMERA
+
+/* The settings initialize_camera_window used to send, in order */
+static rom const char *rom const cam_link_cmds[] =
+{
+  "BM 1",       /* Keep frame, once captured */
+  "PM 1",       /* Enable poll mode */
+  "RM 1",       /* Enable raw mode */
+  "NF 6",       /* Noise filter to level 6 */
+  "CR 0 32",    /* Set AGC to MID level */
+  "CR 18 0",    /* Set into yCrCb instead of RGB */
+  "SO 0 1"      /* Servo 0 setup */
+};
+
+#define CAM_LINK_CMDS  (sizeof(cam_link_cmds) / sizeof(cam_link_cmds[0]))
+
+/* What Cam_Link_Reply found */
+#define CAM_REPLY_NONE  0
+#define CAM_REPLY_ACK   1
+#define CAM_REPLY_BAD   2
+
+unsigned char cam_link_state = CAM_LINK_OFF;
+unsigned int cam_link_ready_ms = 0;
+unsigned char cam_link_failures = 0;
+unsigned char cam_link_recoveries = 0;
+unsigned int cam_link_recover_ms = 0;
+unsigned int cam_link_recover_max = 0;
+
+static unsigned char cam_link_cmd;      /* cam_link_cmds entry waiting for its ACK */
+static unsigned char cam_link_ping;     /* cam_link_cmds entry the next ping sends */
+static unsigned char cam_link_misses;   /* camera_getACK misses in a row */
+static unsigned char cam_link_down = 0; /* failed, not back up yet */
+static unsigned int cam_link_since;     /* tick the last command went out */
+static unsigned int cam_link_quiet;     /* tick anything last talked to the camera */
+static unsigned int cam_link_down_at;   /* tick it was found failed */
+
+/*******************************************************************************
+* FUNCTION NAME: Cam_Link_Send
+* PURPOSE:       Sends a command and the '\r' that ends it, and clears the
+*                receive buffer for the reply.
+* CALLED FROM:   this file
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     cmd            rom const char * I    command, without the '\r'
+* RETURNS:       void
+*******************************************************************************/
+static void Cam_Link_Send(rom const char *cmd)
+{
+  Serial_Write(CAMERA_PORT, cmd, strlenpgm(cmd));
+  Serial_Write(CAMERA_PORT, "\r", 1);
+  reset_rx_buffer();
+  cam_link_since = Scheduler_Get_Ticks();
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Cam_Link_Reply
+* PURPOSE:       Looks at what came back since the last Cam_Link_Send.
+* CALLED FROM:   this file, Camera_Link_Task
+* ARGUMENTS:     none
+* RETURNS:       CAM_REPLY_NONE  nothing yet
+*                CAM_REPLY_ACK   an ACK
+*                CAM_REPLY_BAD   a NCK, anything else, or CAM_LINK_ACK_MS
+*                                went by with no reply
+*******************************************************************************/
+static unsigned char Cam_Link_Reply(void)
+{
+  if (data_rdy)
+    return cam_uart_buffer[0] == 'A' ? CAM_REPLY_ACK : CAM_REPLY_BAD;
+  if (Scheduler_Get_Ticks() - cam_link_since >= CAM_LINK_ACK_MS)
+    return CAM_REPLY_BAD;
+  return CAM_REPLY_NONE;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Cam_Link_Reset
+* PURPOSE:       Sends the camera reset, the first step of the bring-up.
+* CALLED FROM:   this file, Camera_Link_Task
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+static void Cam_Link_Reset(void)
+{
+  parse_mode = 0;                   /* '\r' lines, for the ACKs */
+  Serial_Write(CAMERA_PORT, "rs\r", 3);
+  reset_rx_buffer();
+  cam_link_since = Scheduler_Get_Ticks();
+  cam_link_state = CAM_LINK_RESET;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Cam_Link_Fail
+* PURPOSE:       Counts a failure and starts the wait before the next reset.
+* CALLED FROM:   this file
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+static void Cam_Link_Fail(void)
+{
+  if (cam_link_failures < 255)
+    cam_link_failures++;
+  if (!cam_link_down)
+  {
+    cam_link_down = 1;
+    cam_link_down_at = Scheduler_Get_Ticks();
+  }
+  cam_link_misses = 0;
+  cam_link_since = Scheduler_Get_Ticks();
+  cam_link_state = CAM_LINK_FAILED;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Cam_Link_Up
+* PURPOSE:       The setup went through.  If this was a recovery, times it.
+* CALLED FROM:   this file, Camera_Link_Task
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+static void Cam_Link_Up(void)
+{
+  reset_rx_buffer();
+  cam_link_ready_ms = cam_link_quiet = Scheduler_Get_Ticks();
+  if (cam_link_down)
+  {
+    cam_link_down = 0;
+    cam_link_recover_ms = cam_link_ready_ms - cam_link_down_at;
+    if (cam_link_recover_ms > cam_link_recover_max)
+      cam_link_recover_max = cam_link_recover_ms;
+    if (cam_link_recoveries < 255)
+      cam_link_recoveries++;
+  }
+  cam_link_state = CAM_LINK_READY;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Camera_Link_Task
+* PURPOSE:       Takes the camera bring-up one step, or checks on the
+*                camera once it's up.
+* CALLED FROM:   user_scheduler.c, every 5ms
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Camera_Link_Task(void)
+{
+  unsigned char reply;
+
+  switch (cam_link_state)
+  {
+    case CAM_LINK_OFF:
+      if (Scheduler_Get_Ticks() >= CAM_LINK_POWERUP_MS)
+        Cam_Link_Reset();
+      break;
+
+    case CAM_LINK_RESET:
+      reply = Cam_Link_Reply();
+      if (reply == CAM_REPLY_ACK)
+      {
+        cam_link_since = Scheduler_Get_Ticks();
+        cam_link_state = CAM_LINK_SETTLE;
+      }
+      else if (reply == CAM_REPLY_BAD)
+        Cam_Link_Fail();
+      break;
+
+    case CAM_LINK_SETTLE:
+      if (Scheduler_Get_Ticks() - cam_link_since < CAM_LINK_SETTLE_MS)
+        break;
+      cam_link_cmd = 0;             /* the version line is thrown away here */
+      Cam_Link_Send(cam_link_cmds[0]);
+      cam_link_state = CAM_LINK_CONFIG;
+      break;
+
+    case CAM_LINK_CONFIG:
+      reply = Cam_Link_Reply();
+      if (reply == CAM_REPLY_BAD)
+        Cam_Link_Fail();
+      else if (reply == CAM_REPLY_ACK)
+      {
+        if (++cam_link_cmd < CAM_LINK_CMDS)
+          Cam_Link_Send(cam_link_cmds[cam_link_cmd]);
+        else
+          Cam_Link_Up();
+      }
+      break;
+
+    case CAM_LINK_READY:
+      if (Scheduler_Get_Ticks() - cam_link_quiet < CAM_LINK_PING_MS)
+        break;
+      Cam_Link_Send(cam_link_cmds[cam_link_ping]);
+      if (++cam_link_ping >= CAM_LINK_CMDS)
+        cam_link_ping = 0;
+      cam_link_state = CAM_LINK_PING;
+      break;
+
+    case CAM_LINK_PING:
+      reply = Cam_Link_Reply();
+      if (reply == CAM_REPLY_BAD)
+        Cam_Link_Fail();
+      else if (reply == CAM_REPLY_ACK)
+      {
+        reset_rx_buffer();
+        cam_link_quiet = Scheduler_Get_Ticks();
+        cam_link_state = CAM_LINK_READY;
+      }
+      break;
+
+    case CAM_LINK_FAILED:
+    default:
+      if (Scheduler_Get_Ticks() - cam_link_since >= CAM_LINK_RETRY_MS)
+        Cam_Link_Reset();
+      break;
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Camera_Link_Ready
+* PURPOSE:       Tells if the camera is up and set up.  A ping going out
+*                doesn't count against it, the next command cancels the
+*                ping.
+* CALLED FROM:   user_camera.c, probe_pos
+* ARGUMENTS:     none
+* RETURNS:       1 if it is, 0 if it's coming up or coming back
+*******************************************************************************/
+unsigned char Camera_Link_Ready(void)
+{
+  return cam_link_state == CAM_LINK_READY || cam_link_state == CAM_LINK_PING;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Camera_Link_Activity
+* PURPOSE:       Hears about a command someone else sent.  The camera isn't
+*                quiet, so a ping going out is called off (its reply would
+*                have been thrown away by camera_getACK anyway).  Too many
+*                misses in a row and the camera is counted as failed.
+* CALLED FROM:   user_camera.c, camera_getACK
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     acked          unsigned char    I    1 if the camera answered
+* RETURNS:       void
+*******************************************************************************/
+void Camera_Link_Activity(unsigned char acked)
+{
+  if (cam_link_state == CAM_LINK_PING)
+    cam_link_state = CAM_LINK_READY;
+  if (cam_link_state != CAM_LINK_READY)
+    return;
+
+  cam_link_quiet = Scheduler_Get_Ticks();
+  if (acked)
+    cam_link_misses = 0;
+  else if (++cam_link_misses >= CAM_LINK_MISSES)
+    Cam_Link_Fail();
+}
+
+#endif
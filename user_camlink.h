@@ -0,0 +1,47 @@
+/*******************************************************************************
+* FILE NAME: user_camlink.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_camlink.c
+*  It contains the steps of the camera bring-up and how long each may take.
+*
+* USAGE:
+*  Nothing may talk to the camera unless Camera_Link_Ready says it's up.
+*  Anything that does has to go through camera_getACK, so the supervisor
+*  hears about it.
+*******************************************************************************/
+#ifndef __user_camlink_h_
+#define __user_camlink_h_
+
+/* cam_link_state */
+#define CAM_LINK_OFF      0     /* waiting for the camera to power up */
+#define CAM_LINK_RESET    1     /* "rs" sent, waiting for the ACK */
+#define CAM_LINK_SETTLE   2     /* letting the camera finish its reset */
+#define CAM_LINK_CONFIG   3     /* a setup command sent, waiting for the ACK */
+#define CAM_LINK_READY    4     /* set up, the camera commands can be used */
+#define CAM_LINK_FAILED   5     /* no ACK, or something else came back */
+#define CAM_LINK_PING     6     /* up, and checking that it still is */
+
+#define CAM_LINK_POWERUP_MS 500   /* after the scheduler starts */
+#define CAM_LINK_ACK_MS     50    /* about what wait_for_data allows */
+#define CAM_LINK_SETTLE_MS  50    /* for the version line after "rs" */
+#define CAM_LINK_RETRY_MS   200   /* after a failure, before the next "rs" */
+#define CAM_LINK_PING_MS    1000  /* quiet this long, check on it */
+#define CAM_LINK_MISSES     3     /* camera_getACK misses in a row that mean it's gone */
+
+extern unsigned char cam_link_state;
+extern unsigned int cam_link_ready_ms;    /* scheduler tick it last came up on */
+extern unsigned char cam_link_failures;   /* times it was found not answering */
+extern unsigned char cam_link_recoveries; /* times it came back after that */
+extern unsigned int cam_link_recover_ms;  /* failure to back up, last time */
+extern unsigned int cam_link_recover_max; /* and the longest */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_camlink.c */
+void Camera_Link_Task(void);
+unsigned char Camera_Link_Ready(void);
+void Camera_Link_Activity(unsigned char acked);
+
+#endif
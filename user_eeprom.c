@@ -0,0 +1,302 @@
+/*******************************************************************************
+* FILE NAME: user_eeprom.c
+*
+* DESCRIPTION:
+*  This file contains the non-volatile profile store.  The 1K data EEPROM is
+*  split into 64 slots of 16 bytes.  Every save goes into the next slot round
+*  the ring as a record holding a version, a sequence number, the data and a
+*  CRC-16, and at power up the valid record with the newest sequence number
+*  is loaded.  A save that is cut off by a power loss just fails its CRC and
+*  the record before it is used instead.
+*
+*  An EEPROM byte write takes about 4ms, so nothing here waits for one.
+*  Eeprom_Store only copies the data and returns; the bytes are written one
+*  at a time, each one started from the EEPROM write complete interrupt of
+*  the one before.  Bytes that already hold the right value are skipped.
+*
+*  Wear: the cells are good for 100,000 writes and each save touches one
+*  slot, so a byte is written once every 64 saves.  That is over six million
+*  saves, and a save only happens when the data actually changed.
+*
+*  The write unlock sequence must not be interrupted.  The high priority
+*  interrupt belongs to the IFI library and can't be masked, so if it lands
+*  in the middle of the sequence the write doesn't start.  That is checked
+*  (WR still clear) and Eeprom_Task starts the byte again.
+*
+* USAGE:
+*  Eeprom_Load may only be used before the first Eeprom_Store, it shares
+*  the EEPROM address registers with the writes.
+*******************************************************************************/
+
+#include <string.h>
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_eeprom.h"
+
+unsigned char ee_write_errors = 0;
+unsigned int ee_records_written = 0;
+
+static unsigned char ee_buf[EE_SLOT_SIZE];    /* record being written */
+static unsigned char ee_pos;                  /* next byte of ee_buf to write */
+static volatile unsigned char ee_state = EE_IDLE;
+static unsigned char ee_slot;                 /* slot of the newest record */
+static unsigned int ee_seq;                   /* its sequence number */
+static unsigned char ee_pending = 0;          /* ee_image needs writing */
+static unsigned char ee_image[EE_DATA_MAX];   /* what the EEPROM should hold */
+static unsigned char ee_len = 0;
+
+static unsigned char ee_read(unsigned int addr);
+static unsigned int ee_crc(const unsigned char *buf, unsigned char len);
+static void ee_start_byte(void);
+
+/*******************************************************************************
+* FUNCTION NAME: Eeprom_Initialize
+* PURPOSE:       Finds the newest good record and enables the write complete
+*                interrupt.
+* CALLED FROM:   user_routines.c, User_Initialization
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Eeprom_Initialize(void)
+{
+  unsigned char slot;
+  unsigned char i;
+  unsigned int addr;
+  unsigned int seq;
+  unsigned char found = 0;
+
+  ee_slot = EE_SLOTS - 1;         /* so an empty EEPROM starts at slot 0 */
+  ee_seq = 0;
+
+  for (slot = 0; slot < EE_SLOTS; slot++)
+  {
+    addr = (unsigned int)slot * EE_SLOT_SIZE;
+    for (i = 0; i < EE_SLOT_SIZE; i++)
+      ee_buf[i] = ee_read(addr + i);
+
+    if (ee_buf[EE_OFS_VERSION] != EE_VERSION || ee_buf[EE_OFS_LEN] > EE_DATA_MAX)
+      continue;
+    if (ee_crc(ee_buf, EE_OFS_CRC) !=
+        (((unsigned int)ee_buf[EE_OFS_CRC] << 8) | ee_buf[EE_OFS_CRC + 1]))
+      continue;
+
+    seq = ((unsigned int)ee_buf[EE_OFS_SEQ] << 8) | ee_buf[EE_OFS_SEQ + 1];
+    if (!found || (int)(seq - ee_seq) > 0)    /* newer, wrap safe */
+    {
+      found = 1;
+      ee_slot = slot;
+      ee_seq = seq;
+      ee_len = ee_buf[EE_OFS_LEN];
+      memcpy((void *)ee_image, (void *)&ee_buf[EE_OFS_DATA], EE_DATA_MAX);
+    }
+  }
+
+  EECON1bits.EEPGD = 0;           /* data EEPROM, not flash */
+  EECON1bits.CFGS = 0;
+  IPR2bits.EEIP = 0;              /* low priority */
+  PIR2bits.EEIF = 0;
+  PIE2bits.EEIE = 1;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Eeprom_Load
+* PURPOSE:       Copies the newest saved data out.
+* CALLED FROM:   user_routines.c, activate_profile
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     data           unsigned char *  O    where to put it
+*     len            unsigned char    I    how many bytes are wanted
+* RETURNS:       1 if a saved record of that size was found, else 0
+*******************************************************************************/
+unsigned char Eeprom_Load(unsigned char *data, unsigned char len)
+{
+  if (ee_len == 0 || ee_len != len)
+    return 0;
+  memcpy((void *)data, (void *)ee_image, len);
+  return 1;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Eeprom_Store
+* PURPOSE:       Saves the data if it is different from what is saved.  Only
+*                copies it here, Eeprom_Task and the interrupt write it.
+* CALLED FROM:   user_routines.c, store_profile
+* ARGUMENTS:
+*     Argument       Type                   IO   Description
+*     --------       -------------          --   -----------
+*     data           const unsigned char *  I    data to save
+*     len            unsigned char          I    bytes, up to EE_DATA_MAX
+* RETURNS:       void
+*******************************************************************************/
+void Eeprom_Store(const unsigned char *data, unsigned char len)
+{
+  if (len > EE_DATA_MAX)
+    return;
+  if (len == ee_len && memcmp((void *)data, (void *)ee_image, len) == 0)
+    return;                       /* nothing changed */
+
+  memcpy((void *)ee_image, (void *)data, len);
+  ee_len = len;
+  ee_pending = 1;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Eeprom_Task
+* PURPOSE:       Starts writing a pending record, or restarts a byte whose
+*                unlock sequence was broken up by a high priority interrupt.
+* CALLED FROM:   user_scheduler.c, every 10ms
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Eeprom_Task(void)
+{
+  unsigned int crc;
+
+  if (ee_state == EE_RETRY)
+  {
+    INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+    ee_start_byte();
+    INTCONbits.PEIE = 1;          /* Enable low priority interrupts */
+    return;
+  }
+
+  if (ee_state != EE_IDLE || !ee_pending)
+    return;
+
+  ee_pending = 0;
+  ee_seq++;
+  ee_slot = (ee_slot + 1) % EE_SLOTS;
+
+  memset((void *)ee_buf, 0, EE_SLOT_SIZE);
+  ee_buf[EE_OFS_VERSION] = EE_VERSION;
+  ee_buf[EE_OFS_LEN] = ee_len;
+  ee_buf[EE_OFS_SEQ] = ee_seq >> 8;
+  ee_buf[EE_OFS_SEQ + 1] = ee_seq;
+  memcpy((void *)&ee_buf[EE_OFS_DATA], (void *)ee_image, ee_len);
+  crc = ee_crc(ee_buf, EE_OFS_CRC);
+  ee_buf[EE_OFS_CRC] = crc >> 8;
+  ee_buf[EE_OFS_CRC + 1] = crc;
+
+  ee_pos = 0;
+  INTCONbits.PEIE = 0;            /* Disable low priority interrupts */
+  ee_start_byte();
+  INTCONbits.PEIE = 1;            /* Enable low priority interrupts */
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Eeprom_Write_Done
+* PURPOSE:       Checks the byte that just finished and starts the next one.
+* CALLED FROM:   user_routines_fast.c, InterruptHandlerLow
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Eeprom_Write_Done(void)
+{
+  EECON1bits.WREN = 0;
+  if (ee_state != EE_WRITING)
+    return;
+
+  if (ee_read((unsigned int)ee_slot * EE_SLOT_SIZE + ee_pos) != ee_buf[ee_pos])
+    ee_write_errors++;            /* write it again */
+  else ee_pos++;
+
+  ee_start_byte();
+}
+
+/*******************************************************************************
+* FUNCTION NAME: ee_start_byte
+* PURPOSE:       Starts writing ee_buf[ee_pos], skipping bytes that already
+*                match.  Low priority interrupts must be off.
+* CALLED FROM:   this file
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+static void ee_start_byte(void)
+{
+  unsigned int addr;
+
+  addr = (unsigned int)ee_slot * EE_SLOT_SIZE;
+  while (ee_pos < EE_SLOT_SIZE && ee_read(addr + ee_pos) == ee_buf[ee_pos])
+    ee_pos++;
+
+  if (ee_pos >= EE_SLOT_SIZE)
+  {
+    ee_state = EE_IDLE;
+    ee_records_written++;
+    return;
+  }
+
+  EEADRH = (addr + ee_pos) >> 8;
+  EEADR = addr + ee_pos;
+  EEDATA = ee_buf[ee_pos];
+  EECON1bits.EEPGD = 0;
+  EECON1bits.CFGS = 0;
+  EECON1bits.WREN = 1;
+  _asm
+    MOVLW 0x55
+    MOVWF EECON2, 0
+    MOVLW 0xAA
+    MOVWF EECON2, 0
+    BSF EECON1, 1, 0
+  _endasm
+
+  if (EECON1bits.WR)
+    ee_state = EE_WRITING;
+  else
+  {
+    EECON1bits.WREN = 0;          /* the sequence was interrupted */
+    ee_state = EE_RETRY;
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: ee_read
+* PURPOSE:       Reads one byte of data EEPROM, it is ready straight away.
+* CALLED FROM:   this file
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     addr           unsigned int     I    0 - 1023
+* RETURNS:       unsigned char
+*******************************************************************************/
+static unsigned char ee_read(unsigned int addr)
+{
+  EEADRH = addr >> 8;
+  EEADR = addr;
+  EECON1bits.EEPGD = 0;
+  EECON1bits.CFGS = 0;
+  EECON1bits.RD = 1;
+  return EEDATA;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: ee_crc
+* PURPOSE:       CRC-16/CCITT (polynomial 0x1021, start 0xFFFF).
+* CALLED FROM:   this file
+* ARGUMENTS:
+*     Argument       Type                   IO   Description
+*     --------       -------------          --   -----------
+*     buf            const unsigned char *  I    bytes to check
+*     len            unsigned char          I    how many
+* RETURNS:       unsigned int
+*******************************************************************************/
+static unsigned int ee_crc(const unsigned char *buf, unsigned char len)
+{
+  unsigned int crc = 0xFFFF;
+  unsigned char i;
+
+  while (len--)
+  {
+    crc ^= (unsigned int)*buf++ << 8;
+    for (i = 0; i < 8; i++)
+    {
+      if (crc & 0x8000)
+        crc = (crc << 1) ^ 0x1021;
+      else crc <<= 1;
+    }
+  }
+  return crc;
+}
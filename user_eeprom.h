@@ -0,0 +1,47 @@
+/*******************************************************************************
+* FILE NAME: user_eeprom.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_eeprom.c
+*  It contains the layout of a saved record in the 1K data EEPROM.
+*
+* USAGE:
+*  Change EE_VERSION whenever the layout of what is saved (struct
+*  mhs166_profile) changes, so an old record isn't loaded into the new layout.
+*******************************************************************************/
+#ifndef __user_eeprom_h_
+#define __user_eeprom_h_
+
+#define EE_VERSION      1     /* bump when struct mhs166_profile changes */
+
+#define EE_SIZE         1024  /* bytes of data EEPROM on the 18F8520 */
+#define EE_SLOT_SIZE    16    /* bytes per record */
+#define EE_SLOTS        (EE_SIZE / EE_SLOT_SIZE)
+
+/* Record layout, each record is one slot */
+#define EE_OFS_VERSION  0     /* EE_VERSION */
+#define EE_OFS_LEN      1     /* bytes of data */
+#define EE_OFS_SEQ      2     /* 16 bit sequence number, newest wins */
+#define EE_OFS_DATA     4
+#define EE_OFS_CRC      (EE_SLOT_SIZE - 2)  /* CRC-16 of everything before it */
+#define EE_DATA_MAX     (EE_OFS_CRC - EE_OFS_DATA)
+
+/* Write states, see ee_state */
+#define EE_IDLE         0
+#define EE_WRITING      1     /* waiting for the EEPROM write complete interrupt */
+#define EE_RETRY        2     /* the last byte didn't start, Eeprom_Task retries */
+
+extern unsigned char ee_write_errors;   /* bytes that didn't verify */
+extern unsigned int ee_records_written;
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_eeprom.c */
+void Eeprom_Initialize(void);
+unsigned char Eeprom_Load(unsigned char *data, unsigned char len);
+void Eeprom_Store(const unsigned char *data, unsigned char len);
+void Eeprom_Task(void);
+void Eeprom_Write_Done(void);
+
+#endif
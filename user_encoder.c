@@ -0,0 +1,143 @@
+/*******************************************************************************
+* FILE NAME: user_encoder.c
+*
+* DESCRIPTION:
+*  This file contains the wheel tick counters.  The left and right banner
+*  sensors are wired to the INT2 and INT3 pins (digital I/O 1 and 2) and
+*  every edge is counted by InterruptHandlerLow, so no stripe is missed no
+*  matter how fast the wheels turn.  The banner sensors can't tell which way
+*  the wheel is turning, so the count direction is taken from the PWM we last
+*  commanded on that side.
+*
+*  The otis (lift) height sensor is on digital I/O 3 (RB4) and is counted on
+*  the port B change interrupt the same way, with its direction from the
+*  lift PWM.  The count is zeroed whenever the bottom limit switch is closed.
+*
+* USAGE:
+*  Encoder_Update is called at the top of every control frame and
+*  Encoder_Set_Direction at the bottom, once the new outputs are known.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_encoder.h"
+#include "user_frame.h"
+#include "user_odometry.h"
+#include "user_input.h"
+#include "user_arena.h"
+
+volatile int enc_left_ticks = 0;
+volatile int enc_right_ticks = 0;
+volatile signed char enc_left_dir = 1;
+volatile signed char enc_right_dir = 1;
+volatile int enc_lift_ticks = 0;
+volatile signed char enc_lift_dir = 1;
+volatile unsigned char enc_lift_last;   /* otis_counter at the last interrupt */
+
+unsigned char lift_homed = 0;
+
+/*******************************************************************************
+* FUNCTION NAME: Encoder_Initialize
+* PURPOSE:       Sets up INT2 and INT3 to interrupt on the next edge of the
+*                banner sensors.  The ISR flips the edge select every time, so
+*                both the rising and falling edge of each stripe are counted.
+*                Also turns on the port B change interrupt for the lift.
+* CALLED FROM:   user_routines.c, User_Initialization
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Encoder_Initialize(void)
+{
+  Encoder_Reset();
+
+  INTCON2bits.INTEDG2 = !L_banner;  /* wait for the pin to change */
+  INTCON2bits.INTEDG3 = !R_banner;
+  INTCON3bits.INT2IP = 0;           /* must be low priority */
+  INTCON2bits.INT3IP = 0;
+  INTCON3bits.INT2IF = 0;
+  INTCON3bits.INT3IF = 0;
+  INTCON3bits.INT2IE = 1;
+  INTCON3bits.INT3IE = 1;
+
+  enc_lift_last = PORTB & 0x10;    /* RB4, reading PORTB also ends the mismatch */
+  INTCONbits.RBIF = 0;
+  INTCONbits.RBIE = 1;              /* IFI already has RB changes at low priority */
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Encoder_Reset
+* PURPOSE:       Zeroes the wheel counters and the snapshot.  The lift count
+*                is left alone, only the bottom limit switch zeroes that.
+* CALLED FROM:   anywhere
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Encoder_Reset(void)
+{
+  INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+  enc_left_ticks = 0;
+  enc_right_ticks = 0;
+  INTCONbits.PEIE = 1;          /* Enable low priority interrupts */
+
+  encoders.left = encoders.right = 0;
+  encoders.left_rate = encoders.right_rate = 0;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Encoder_Update
+* PURPOSE:       Takes a consistent snapshot of the 16 bit counters and works
+*                out how many ticks each side moved since the last frame.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Encoder_Update(void)
+{
+  int left;
+  int right;
+
+  INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+  left = enc_left_ticks;
+  right = enc_right_ticks;
+  if (lift_bottom == CLOSED)
+    enc_lift_ticks = 0;         /* at the bottom, this is where we count from */
+  encoders.otis = enc_lift_ticks;
+  INTCONbits.PEIE = 1;          /* Enable low priority interrupts */
+
+  if (lift_bottom == CLOSED)
+    lift_homed = 1;
+
+  encoders.left_rate = left - encoders.left;
+  encoders.right_rate = right - encoders.right;
+  encoders.left = left;
+  encoders.right = right;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Encoder_Set_Direction
+* PURPOSE:       Tells the ISR which way to count from the drive and lift PWMs
+*                we are about to send.  At neutral the last direction is kept, since
+*                a coasting robot keeps rolling the way it was going.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Encoder_Set_Direction(void)
+{
+  if (drive_L > 127)
+    enc_left_dir = 1;
+  else if (drive_L < 127)
+    enc_left_dir = -1;
+
+  if (drive_R > 127)
+    enc_right_dir = 1;
+  else if (drive_R < 127)
+    enc_right_dir = -1;
+
+  if (lift > 127)               /* lift_speed_up is above neutral */
+    enc_lift_dir = 1;
+  else if (lift < 127)
+    enc_lift_dir = -1;
+}
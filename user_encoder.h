@@ -0,0 +1,52 @@
+/*******************************************************************************
+* FILE NAME: user_encoder.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_encoder.c
+*  It contains the wheel and lift counters kept by InterruptHandlerLow and
+*  the per-frame snapshot the rest of the code reads.
+*
+* USAGE:
+*  Read the wheel counts from "encoders" only.  It is refreshed once per
+*  control frame by Encoder_Update, so every routine in a frame sees the same
+*  numbers.
+*******************************************************************************/
+#ifndef __user_encoder_h_
+#define __user_encoder_h_
+
+/*
+ * Per-frame copy of the wheel counters.  Counts are signed, forward is
+ * positive, and there are two counts per banner stripe (both edges).
+ */
+typedef struct
+{
+  int left;             /* left wheel ticks since Encoder_Reset */
+  int right;            /* right wheel ticks since Encoder_Reset */
+  int left_rate;        /* left ticks during the last 26.2ms frame */
+  int right_rate;       /* right ticks during the last 26.2ms frame */
+  int otis;             /* lift clicks above the bottom limit switch */
+} ENCODER_SNAPSHOT;
+
+/* encoders is in the hot state, see user_arena.h */
+
+/* Owned by InterruptHandlerLow, don't read these directly */
+extern volatile int enc_left_ticks;
+extern volatile int enc_right_ticks;
+extern volatile signed char enc_left_dir;
+extern volatile signed char enc_right_dir;
+extern volatile int enc_lift_ticks;
+extern volatile signed char enc_lift_dir;
+extern volatile unsigned char enc_lift_last;
+
+extern unsigned char lift_homed;    /* lift has been to the bottom since power up */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_encoder.c */
+void Encoder_Initialize(void);
+void Encoder_Reset(void);
+void Encoder_Update(void);
+void Encoder_Set_Direction(void);
+
+#endif
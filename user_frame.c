@@ -0,0 +1,89 @@
+/*******************************************************************************
+* FILE NAME: user_frame.c
+*
+* DESCRIPTION:
+*  This file contains the two ends of the 26.2ms frame.  Everything the
+*  routines in between look at is latched once at the start, and everything
+*  they set goes out together at the end:
+*
+*  - Frame_Latch reads the digital input ports into frame_in, so a limit
+*    switch that closes halfway through the frame can't be open for one
+*    routine and closed for the next.  It also latches the OI switch edges
+*    (user_input.c) and the last whole breaker panel packet.  rxdata is
+*    already a copy, Getdata fills it and nothing else writes it.
+*  - The jump in rxdata.packet_num since the last frame becomes frame_steps,
+*    and the drops are counted.
+*  - The relays are set in frame_out and Frame_Commit writes them to the
+*    port latches, so a relay that is cleared and then set again in the
+*    same frame never blips.  The PWMs and OI LEDs already work this way,
+*    nothing sends txdata until Putdata.
+*
+* USAGE:
+*  Frame_Latch goes right after Getdata and Frame_Commit right before
+*  Putdata.  Nothing run from the interrupts may use frame_in or frame_out.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_Serialdrv.h"
+#include "user_input.h"
+#include "user_frame.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_arena.h"
+
+unsigned int frame_drops = 0;
+unsigned int frame_gaps = 0;
+unsigned char frame_gap_max = 0;
+
+static unsigned char frame_started = 0;   /* frame_last_packet is valid */
+static unsigned char frame_last_packet;
+
+/*******************************************************************************
+* FUNCTION NAME: Frame_Latch
+* PURPOSE:       Latches every input for this frame.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Frame_Latch(void)
+{
+  unsigned char steps;
+
+  steps = rxdata.packet_num - frame_last_packet;
+  if (!frame_started || steps == 0)
+    steps = 1;
+  frame_started = 1;
+  frame_last_packet = rxdata.packet_num;
+  if (steps > 1)
+  {
+    frame_gaps++;
+    frame_drops += steps - 1;
+    if (steps - 1 > frame_gap_max)
+      frame_gap_max = steps - 1;
+  }
+  frame_steps = steps > FRAME_MAX_STEPS ? FRAME_MAX_STEPS : steps;
+
+  frame_in.portb.allbits = PORTB;
+  frame_in.portc.allbits = PORTC;
+  frame_in.porth.allbits = PORTH;
+  frame_in.portj.allbits = PORTJ;
+  Input_Latch();      /* OI switch edges */
+  Panel_Latch();      /* breaker panel */
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Frame_Commit
+* PURPOSE:       Sends the relays set this frame.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Frame_Commit(void)
+{
+  LATD = frame_out.relay_rev.allbits;         /* relay1_rev - relay8_rev */
+  LATE = (LATE & 0x80) | (frame_out.relay_fwd.allbits & 0x7F);
+  LATJbits.LATJ0 = frame_out.relay_fwd.bitselect.bit7;  /* relay8_fwd */
+}
@@ -0,0 +1,109 @@
+/*******************************************************************************
+* FILE NAME: user_frame.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_frame.c
+*  It contains the frame snapshot of the digital inputs and the shadow of
+*  the relay outputs, and aliases for them like the ones in ifi_aliases.h.
+*
+* USAGE:
+*  Use frame_dig_inXX instead of rc_dig_inXX and frame_relayX_fwd/rev
+*  instead of relayX_fwd/rev in anything that runs from
+*  Process_Data_From_Master_uP.  The robot's names for them (lift_bottom,
+*  compressor, ...) are in user_routines.h.
+*******************************************************************************/
+#ifndef __user_frame_h_
+#define __user_frame_h_
+
+typedef union
+{
+  struct
+  {
+    unsigned int bit0:1;
+    unsigned int bit1:1;
+    unsigned int bit2:1;
+    unsigned int bit3:1;
+    unsigned int bit4:1;
+    unsigned int bit5:1;
+    unsigned int bit6:1;
+    unsigned int bit7:1;
+  } bitselect;
+  unsigned char allbits;
+} frame_byte;
+
+/* The input ports, read once at the start of the frame */
+struct frame_inputs
+{
+  frame_byte portb;     /* rc_dig_in01 - 06 on RB2 - RB7 */
+  frame_byte portc;     /* rc_dig_in14 on RC0 */
+  frame_byte porth;     /* rc_dig_in07 - 10 on RH0 - RH3 */
+  frame_byte portj;     /* rc_dig_in11 - 13, 15 - 18 on RJ1 - RJ7 */
+};
+
+/* The relays, written to the port latches at the end of the frame */
+struct frame_outputs
+{
+  frame_byte relay_fwd; /* bit0 = relay1_fwd ... bit7 = relay8_fwd */
+  frame_byte relay_rev; /* bit0 = relay1_rev ... bit7 = relay8_rev */
+};
+
+/* frame_in and frame_out are in the hot state, see user_arena.h */
+
+/*
+ * How many 26.2ms frames this one stands for, from the jump in
+ * rxdata.packet_num: 1, or more when packets were dropped.  Anything that
+ * adds up or ramps once a frame should do it frame_steps times, so it keeps
+ * to the clock.  A gap longer than FRAME_MAX_STEPS counts as that many, so
+ * one long dropout doesn't wind everything up at once.  frame_steps is in
+ * the hot state too.
+ */
+#define FRAME_MAX_STEPS   4
+
+extern unsigned int frame_drops;      /* packets missed since power up */
+extern unsigned int frame_gaps;       /* times one or more were missed */
+extern unsigned char frame_gap_max;   /* most missed in a row */
+
+#define frame_dig_in01    frame_in.portb.bitselect.bit2
+#define frame_dig_in02    frame_in.portb.bitselect.bit3
+#define frame_dig_in03    frame_in.portb.bitselect.bit4
+#define frame_dig_in04    frame_in.portb.bitselect.bit5
+#define frame_dig_in05    frame_in.portb.bitselect.bit6
+#define frame_dig_in06    frame_in.portb.bitselect.bit7
+#define frame_dig_in07    frame_in.porth.bitselect.bit0
+#define frame_dig_in08    frame_in.porth.bitselect.bit1
+#define frame_dig_in09    frame_in.porth.bitselect.bit2
+#define frame_dig_in10    frame_in.porth.bitselect.bit3
+#define frame_dig_in11    frame_in.portj.bitselect.bit1
+#define frame_dig_in12    frame_in.portj.bitselect.bit2
+#define frame_dig_in13    frame_in.portj.bitselect.bit3
+#define frame_dig_in14    frame_in.portc.bitselect.bit0
+#define frame_dig_in15    frame_in.portj.bitselect.bit4
+#define frame_dig_in16    frame_in.portj.bitselect.bit5
+#define frame_dig_in17    frame_in.portj.bitselect.bit6
+#define frame_dig_in18    frame_in.portj.bitselect.bit7
+
+#define frame_relay1_fwd  frame_out.relay_fwd.bitselect.bit0
+#define frame_relay2_fwd  frame_out.relay_fwd.bitselect.bit1
+#define frame_relay3_fwd  frame_out.relay_fwd.bitselect.bit2
+#define frame_relay4_fwd  frame_out.relay_fwd.bitselect.bit3
+#define frame_relay5_fwd  frame_out.relay_fwd.bitselect.bit4
+#define frame_relay6_fwd  frame_out.relay_fwd.bitselect.bit5
+#define frame_relay7_fwd  frame_out.relay_fwd.bitselect.bit6
+#define frame_relay8_fwd  frame_out.relay_fwd.bitselect.bit7
+#define frame_relay1_rev  frame_out.relay_rev.bitselect.bit0
+#define frame_relay2_rev  frame_out.relay_rev.bitselect.bit1
+#define frame_relay3_rev  frame_out.relay_rev.bitselect.bit2
+#define frame_relay4_rev  frame_out.relay_rev.bitselect.bit3
+#define frame_relay5_rev  frame_out.relay_rev.bitselect.bit4
+#define frame_relay6_rev  frame_out.relay_rev.bitselect.bit5
+#define frame_relay7_rev  frame_out.relay_rev.bitselect.bit6
+#define frame_relay8_rev  frame_out.relay_rev.bitselect.bit7
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_frame.c */
+void Frame_Latch(void);
+void Frame_Commit(void);
+
+#endif
@@ -0,0 +1,239 @@
+/*******************************************************************************
+* FILE NAME: user_heading.c
+*
+* DESCRIPTION:
+*  This file contains a PI heading hold for driving straight.  When both
+*  sides are asked for the same speed, the difference between the left and
+*  right wheel counts since the hold was engaged is the heading error, and
+*  the left and right PWMs are trimmed to bring it back to zero.  The
+*  integral is kept from one straight run to the next, so it takes out
+*  whatever pull to one side the drive gains haven't.
+*
+*  While the heading is held, Drive_Calibrate also compares the PWM each side
+*  was sent with how fast its wheel turned, and learns the drive gains in the
+*  profile so the stronger side is turned down to match the weaker one.
+*
+*  It is all integer math, a couple of hundred instruction cycles a frame,
+*  well under 1% of the 26.2ms frame.
+*
+* USAGE:
+*  Call Heading_Hold every frame the robot should go straight and
+*  Heading_Hold_Release on every other frame, so the next straight run
+*  starts holding whatever heading the robot has then.  Drive_Calibrate runs
+*  every frame, after Encoder_Update and before the new outputs are set.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_encoder.h"
+#include "user_heading.h"
+#include "user_odometry.h"
+#include "user_frame.h"
+#include "user_input.h"
+#include "user_arena.h"
+
+extern struct mhs166_profile volatile_profile;
+
+/* In the hot state, see user_arena.h */
+#define hold_engaged  hot.hold_engaged  /* marks are valid */
+#define hold_mark_L   hot.hold_mark_L   /* wheel counts when the hold engaged */
+#define hold_mark_R   hot.hold_mark_R
+#define hold_integral hot.hold_integral /* sum of the heading error */
+
+static unsigned char cal_frames = 0;    /* frames added up so far */
+static struct
+{
+  unsigned int  reverse:1;              /* which direction they were */
+  unsigned int  dirty:1;                /* a gain changed since the last save */
+  unsigned int  :6;
+} cal_flags;
+#define cal_reverse   cal_flags.reverse
+#define cal_dirty     cal_flags.dirty
+static unsigned int cal_rate_L;         /* wheel ticks */
+static unsigned int cal_rate_R;
+static unsigned int cal_pwm_L;          /* PWM counts away from neutral */
+static unsigned int cal_pwm_R;
+
+/*******************************************************************************
+* FUNCTION NAME: Heading_Hold_Reset
+* PURPOSE:       Forgets everything, including the learned pull to one side,
+*                so the integral from teleop doesn't carry into autonomous.
+* CALLED FROM:   user_routines.c, User_Initialization;
+*                user_routines_fast.c, User_Autonomous_Init
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Heading_Hold_Reset(void)
+{
+  hold_engaged = 0;
+  hold_integral = 0;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Heading_Hold_Release
+* PURPOSE:       Stops holding.  The next Heading_Hold holds the heading the
+*                robot has then.
+* CALLED FROM:   anywhere the robot is turning or stopped
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Heading_Hold_Release(void)
+{
+  hold_engaged = 0;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Heading_Hold
+* PURPOSE:       Drives both sides at speed, trimmed to keep the heading.
+* CALLED FROM:   user_routines.c, autonomous code
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     speed          unsigned char    I    PWM for both sides, 127 is stopped
+* RETURNS:       void
+*******************************************************************************/
+void Heading_Hold(unsigned char speed)
+{
+  int err;
+  int trim;
+  int left;
+  int right;
+
+  if (speed == 127)
+  {
+    hold_engaged = 0;
+    set_drive_L(127);
+    set_drive_R(127);
+    return;
+  }
+
+  if (!hold_engaged)
+  {
+    hold_engaged = 1;
+    hold_mark_L = encoders.left;
+    hold_mark_R = encoders.right;
+  }
+
+  /* positive: the left wheel has gone further, we're turning right */
+  err = (encoders.left - hold_mark_L) - (encoders.right - hold_mark_R);
+  if (err > HEADING_ERR_MAX) err = HEADING_ERR_MAX;
+  if (err < -HEADING_ERR_MAX) err = -HEADING_ERR_MAX;
+
+  hold_integral += err * (int)frame_steps;   /* per 26.2ms, even across a gap */
+  if (hold_integral > HEADING_I_MAX) hold_integral = HEADING_I_MAX;
+  if (hold_integral < -HEADING_I_MAX) hold_integral = -HEADING_I_MAX;
+
+  trim = (HEADING_KP * err + HEADING_KI * hold_integral) / 16;
+  if (trim > HEADING_TRIM_MAX) trim = HEADING_TRIM_MAX;
+  if (trim < -HEADING_TRIM_MAX) trim = -HEADING_TRIM_MAX;
+
+  /* the counts are signed, so this slows the leading side either direction */
+  left = (int)speed - trim;
+  right = (int)speed + trim;
+  if (left < 0) left = 0;
+  if (left > 254) left = 254;
+  if (right < 0) right = 0;
+  if (right > 254) right = 254;
+
+  set_drive_L(left);
+  set_drive_R(right);
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Drive_Calibrate
+* PURPOSE:       Learns the drive gains.  Over CAL_FRAMES frames of holding a
+*                heading in one direction, each side's ticks per PWM count is
+*                its strength.  The weaker side gets full gain and the
+*                stronger side the ratio of the two, and the profile gains
+*                are moved a quarter of the way there.  They are saved the
+*                next time the robot is disabled.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Drive_Calibrate(void)
+{
+  int off_L;
+  int off_R;
+  int rate_L;
+  int rate_R;
+  unsigned char reverse;
+  unsigned char *gain_L;
+  unsigned char *gain_R;
+  long eff_L;
+  long eff_R;
+  int target_L;
+  int target_R;
+
+  if (disabled_mode)
+  {
+    if (cal_dirty)
+    {
+      store_profile();
+      cal_dirty = 0;
+    }
+    cal_frames = 0;
+    return;
+  }
+
+  /* drive_L/R still hold what was sent for the frame we just measured */
+  off_L = (int)drive_L - 127;
+  off_R = (int)drive_R - 127;
+  rate_L = encoders.left_rate;
+  rate_R = encoders.right_rate;
+  reverse = (off_L < 0);
+
+  if (off_L < 0) { off_L = -off_L; rate_L = -rate_L; }
+  if (off_R < 0) { off_R = -off_R; rate_R = -rate_R; }
+
+  if (!hold_engaged || (drive_L < 127) != (drive_R < 127) ||
+      off_L < CAL_MIN_PWM || off_R < CAL_MIN_PWM || rate_L < 0 || rate_R < 0 ||
+      (cal_frames && reverse != cal_reverse) || frame_steps != 1)
+  {
+    cal_frames = 0;             /* not a clean straight run, start over */
+    return;
+  }
+
+  if (cal_frames == 0)
+  {
+    cal_reverse = reverse;
+    cal_rate_L = cal_rate_R = 0;
+    cal_pwm_L = cal_pwm_R = 0;
+  }
+  cal_rate_L += rate_L;
+  cal_rate_R += rate_R;
+  cal_pwm_L += off_L;
+  cal_pwm_R += off_R;
+  if (++cal_frames < CAL_FRAMES)
+    return;
+  cal_frames = 0;
+
+  if (cal_rate_L < CAL_MIN_TICKS || cal_rate_R < CAL_MIN_TICKS)
+    return;                     /* a wheel isn't turning, or a sensor is out */
+
+  eff_L = ((long)cal_rate_L << 8) / cal_pwm_L;    /* ticks per PWM count, Q8 */
+  eff_R = ((long)cal_rate_R << 8) / cal_pwm_R;
+
+  target_L = target_R = GAIN_FULL;
+  if (eff_L > eff_R)
+    target_L = (int)((eff_R * GAIN_FULL) / eff_L);
+  else if (eff_R > eff_L)
+    target_R = (int)((eff_L * GAIN_FULL) / eff_R);
+  if (target_L < CAL_MIN_GAIN) target_L = CAL_MIN_GAIN;
+  if (target_R < CAL_MIN_GAIN) target_R = CAL_MIN_GAIN;
+
+  gain_L = &volatile_profile.drive_gain[reverse ? GAIN_L_REV : GAIN_L_FWD];
+  gain_R = &volatile_profile.drive_gain[reverse ? GAIN_R_REV : GAIN_R_FWD];
+
+  /* rounds away from the old value so it can always reach the target */
+  target_L = (target_L - (int)*gain_L) / 4 + (target_L > *gain_L) - (target_L < *gain_L);
+  target_R = (target_R - (int)*gain_R) / 4 + (target_R > *gain_R) - (target_R < *gain_R);
+  if (target_L || target_R)
+  {
+    *gain_L += target_L;
+    *gain_R += target_R;
+    cal_dirty = 1;
+  }
+}
@@ -0,0 +1,39 @@
+/*******************************************************************************
+* FILE NAME: user_heading.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_heading.c
+*  It contains the gains for the heading hold and drive calibration.
+*
+* USAGE:
+*  Gains are Q4 (16 = 1.0) in PWM counts per wheel tick of heading error.
+*  Raise HEADING_KP if the robot snakes slowly back to straight, lower it if
+*  it wobbles.  HEADING_KI takes out a steady pull to one side.
+*******************************************************************************/
+#ifndef __user_heading_h_
+#define __user_heading_h_
+
+#define HEADING_KP          64    /* 4 PWM counts per tick of error */
+#define HEADING_KI          8     /* 0.5 PWM counts per tick per frame */
+#define HEADING_TRIM_MAX    30    /* most the PI may move either side */
+#define HEADING_ERR_MAX     200   /* ticks, keeps the Q4 math in an int */
+#define HEADING_I_MAX       ((HEADING_TRIM_MAX * 16) / HEADING_KI)
+
+#define HEADING_ASSIST      1     /* hold heading when the driver's sticks match */
+#define HEADING_ASSIST_BAND 4     /* how close the sticks must be, PWM counts */
+
+#define CAL_FRAMES          32    /* about 0.84s of straight driving per update */
+#define CAL_MIN_PWM         30    /* below this the motors are in their dead band */
+#define CAL_MIN_TICKS       40    /* per side per update, or the numbers are noise */
+#define CAL_MIN_GAIN        64    /* never turn a side down below half */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_heading.c */
+void Heading_Hold_Reset(void);
+void Heading_Hold(unsigned char speed);
+void Heading_Hold_Release(void);
+void Drive_Calibrate(void);
+
+#endif
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* FILE NAME: user_input.c
+*
+* DESCRIPTION:
+*  This file contains the edge detection for every switch on the OI and the
+*  RC.  Each routine used to keep its own "last time" variable for the one
+*  button it cared about (prev_p3_sw_trig, mode_db, already_shifted, ...).
+*  Now Input_Latch copies the four switch bytes once a frame and works out,
+*  a whole byte at a time, which buttons went on and which went off, so a
+*  routine just tests a bit.
+*
+*  The debounce is done a byte at a time too.  A button is on once it has
+*  read on for IN_DEBOUNCE_FRAMES frames in a row (AND of the history), and
+*  off once it has read off that long (OR of the history).
+*
+* USAGE:
+*  Input_Latch is called from Frame_Latch, right after Getdata, before
+*  anything reads a button.  See user_input.h for how to test one.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_input.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_frame.h"
+#include "user_arena.h"
+
+/* Buttons that get debounced, the ones that toggle something */
+static const rom unsigned char in_debounce_mask[IN_BYTES] =
+{
+  IN_P1_TRIG | IN_P3_TOP,                             /* IN_OI_A */
+  IN_P4_TRIG | IN_P4_TOP | IN_P4_AUX1 | IN_P4_AUX2,   /* IN_OI_B */
+  0,                                                  /* IN_RC_A */
+  0                                                   /* IN_RC_B */
+};
+
+/* Raw bytes from the frames before this one, newest first */
+static unsigned char in_history[IN_BYTES][IN_DEBOUNCE_FRAMES - 1];
+
+/*******************************************************************************
+* FUNCTION NAME: Input_Latch
+* PURPOSE:       Latches the switch bytes and works out the edges.
+* CALLED FROM:   user_frame.c, Frame_Latch
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Input_Latch(void)
+{
+  unsigned char raw[IN_BYTES];
+  unsigned char b;
+  unsigned char k;
+  unsigned char all_on;
+  unsigned char any_on;
+  unsigned char level;
+
+  raw[IN_OI_A] = rxdata.oi_swA_byte.allbits;
+  raw[IN_OI_B] = rxdata.oi_swB_byte.allbits;
+  raw[IN_RC_A] = rxdata.rc_swA_byte.allbits;
+  raw[IN_RC_B] = rxdata.rc_swB_byte.allbits;
+
+  for (b = 0; b < IN_BYTES; b++)
+  {
+    all_on = any_on = raw[b];
+    for (k = 0; k < IN_DEBOUNCE_FRAMES - 1; k++)
+    {
+      all_on &= in_history[b][k];
+      any_on |= in_history[b][k];
+    }
+    for (k = IN_DEBOUNCE_FRAMES - 2; k > 0; k--)
+      in_history[b][k] = in_history[b][k - 1];
+    in_history[b][0] = raw[b];
+
+    level = (in_now[b] | all_on) & any_on;
+    level = (level & in_debounce_mask[b]) | (raw[b] & ~in_debounce_mask[b]);
+
+    in_rise[b] = level & ~in_now[b];
+    in_fall[b] = in_now[b] & ~level;
+    in_now[b] = level;
+  }
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+* FILE NAME: user_input.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_input.c
+*  It contains the switch bytes and the bit of each OI button in them.
+*
+* USAGE:
+*  Test a button with the mask for it against the array for its byte:
+*    if (in_rise[IN_OI_A] & IN_P3_TOP)     p3_sw_top was just pressed
+*    if (in_fall[IN_OI_A] & IN_P3_TRIG)    p3_sw_trig was just let go
+*    if (in_now[IN_OI_B] & IN_P4_AUX1)     p4_sw_aux1 is held
+*  Buttons in in_debounce_mask have to read the same for IN_DEBOUNCE_FRAMES
+*  frames in a row before in_now changes.  The rest change straight away.
+*******************************************************************************/
+#ifndef __user_input_h_
+#define __user_input_h_
+
+/* The switch bytes from the master uP */
+#define IN_OI_A       0     /* rxdata.oi_swA_byte, ports 1 and 3 */
+#define IN_OI_B       1     /* rxdata.oi_swB_byte, ports 2 and 4 */
+#define IN_RC_A       2     /* rxdata.rc_swA_byte */
+#define IN_RC_B       3     /* rxdata.rc_swB_byte */
+#define IN_BYTES      4
+
+/* IN_OI_A */
+#define IN_P1_TRIG    0x01
+#define IN_P1_TOP     0x02
+#define IN_P1_AUX1    0x04
+#define IN_P1_AUX2    0x08
+#define IN_P3_TRIG    0x10
+#define IN_P3_TOP     0x20
+#define IN_P3_AUX1    0x40
+#define IN_P3_AUX2    0x80
+
+/* IN_OI_B */
+#define IN_P2_TRIG    0x01
+#define IN_P2_TOP     0x02
+#define IN_P2_AUX1    0x04
+#define IN_P2_AUX2    0x08
+#define IN_P4_TRIG    0x10
+#define IN_P4_TOP     0x20
+#define IN_P4_AUX1    0x40
+#define IN_P4_AUX2    0x80
+
+#define IN_DEBOUNCE_FRAMES  3   /* about 79ms */
+
+/* In the hot state, see user_arena.h:
+     in_now     switch levels this frame
+     in_rise    went on this frame
+     in_fall    went off this frame */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_input.c */
+void Input_Latch(void);
+
+#endif
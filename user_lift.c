@@ -0,0 +1,230 @@
+/*******************************************************************************
+* FILE NAME: user_lift.c
+*
+* DESCRIPTION:
+*  This file contains the preset positions for the lift (otis).  Lift_Go_To
+*  picks one of the heights in lift_preset_clicks and Lift_Run moves the
+*  lift there, one frame at a time, on a trapezoid: speed up at LIFT_ACCEL
+*  to LIFT_VMAX, and slow down again once the distance left is what it
+*  takes to stop.  The profile says where the lift should be this frame;
+*  the PWM is the profile speed times LIFT_KV plus how far the lift has
+*  fallen behind the profile times LIFT_KP.
+*
+*  The profile is worked out incrementally, there is no table to build when
+*  a move starts, so a new preset can be picked in the middle of a move.
+*
+*  The lift limit switches still stop it, and the goal height switches end a
+*  move to that goal even if the click count says it isn't there yet.  Until
+*  the lift has been to the bottom since power up the count means nothing,
+*  so the first move goes to the bottom before it goes anywhere else.
+*
+* USAGE:
+*  Call Lift_Run every frame that Lift_Moving says a move is going, and
+*  lift_operate the rest of the time.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_encoder.h"
+#include "user_frame.h"
+#include "user_lift.h"
+#include "user_input.h"
+#include "user_odometry.h"
+#include "user_arena.h"
+
+static const rom int lift_preset_clicks[LIFT_PRESETS] =
+{
+  0,                    /* LIFT_PRESET_BOTTOM */
+  LIFT_SIDE_CLICKS,     /* LIFT_PRESET_SIDE */
+  LIFT_CENTER_CLICKS,   /* LIFT_PRESET_CENTER */
+  lift_max              /* LIFT_PRESET_MAX */
+};
+
+/* In the hot state, see user_arena.h */
+#define lift_moving   hot.lift_moving   /* a move is going */
+#define lift_preset   hot.lift_preset   /* where to */
+#define lift_target   hot.lift_target   /* Q4 clicks */
+#define lift_ref      hot.lift_ref      /* where the profile is, Q4 clicks */
+#define lift_vel      hot.lift_vel      /* profile speed, Q4 clicks a frame */
+
+/*******************************************************************************
+* FUNCTION NAME: Lift_Go_To
+* PURPOSE:       Starts moving the lift to a preset height.
+* CALLED FROM:   this file, Lift_Buttons; user_autoscript.c
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     preset         unsigned char    I    LIFT_PRESET_BOTTOM ... _MAX
+* RETURNS:       void
+*******************************************************************************/
+void Lift_Go_To(unsigned char preset)
+{
+  if (preset >= LIFT_PRESETS)
+    return;
+
+  if (!lift_moving)
+  {
+    lift_ref = encoders.otis * 16;    /* start from where it is, stopped */
+    lift_vel = 0;
+  }
+  lift_preset = preset;
+  lift_target = lift_preset_clicks[preset] * 16;
+  lift_moving = 1;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Lift_Stop
+* PURPOSE:       Ends the move, the lift is left to lift_operate.
+* CALLED FROM:   this file, user_autoscript.c
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Lift_Stop(void)
+{
+  lift_moving = 0;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Lift_Moving
+* PURPOSE:       Tells if a move is going.
+* CALLED FROM:   user_routines.c, user_autoscript.c
+* ARGUMENTS:     none
+* RETURNS:       1 until the lift gets to the preset, then 0
+*******************************************************************************/
+unsigned char Lift_Moving(void)
+{
+  return lift_moving;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Lift_Run
+* PURPOSE:       Steps the profile, by frame_steps frames, and sets the
+*                lift PWM.
+* CALLED FROM:   user_routines.c, Default_Routine; user_autoscript.c
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Lift_Run(void)
+{
+  int err;
+  int speed;
+  int out;
+
+  if (!lift_moving)
+  {
+    lift = 127;
+    return;
+  }
+
+  if (!lift_homed)
+  {
+    /* Don't know where it is yet.  Go down until lift_bottom closes, which
+       zeroes the count, and start the profile from there. */
+    lift_ref = 0;
+    lift_vel = 0;
+    if (lift_bottom)
+      lift = lift_speed_down;
+    else
+    {
+      lift = 127;
+      if (lift_preset == LIFT_PRESET_BOTTOM)
+        lift_moving = 0;
+    }
+    return;
+  }
+
+  if ((lift_preset == LIFT_PRESET_SIDE && goal_side == CLOSED) ||
+      (lift_preset == LIFT_PRESET_CENTER && goal_center == CLOSED))
+  {
+    lift = 127;             /* the goal switch says we're there */
+    lift_moving = 0;
+    return;
+  }
+
+  /* Profile speed for this frame */
+  err = lift_target - lift_ref;
+  speed = lift_vel < 0 ? -lift_vel : lift_vel;
+  if ((lift_vel > 0 && err < 0) || (lift_vel < 0 && err > 0))
+  {
+    speed -= LIFT_ACCEL;    /* going the wrong way, stop first */
+    if (speed < 0)
+      speed = 0;
+    lift_vel = lift_vel < 0 ? -speed : speed;
+  }
+  else
+  {
+    if (err < 0)
+      err = -err;
+    if ((long)speed * speed / (2 * LIFT_ACCEL) >= err)
+      speed -= LIFT_ACCEL;  /* time to slow down */
+    else if (speed < LIFT_VMAX)
+      speed += LIFT_ACCEL;
+    if (speed < 0)
+      speed = 0;
+    if (speed > err)
+      speed = err;          /* land on the target */
+    lift_vel = lift_target < lift_ref ? -speed : speed;
+  }
+  /* Move the profile on by the frames that went by, not just this one,
+     but don't let a gap carry it past the target */
+  err = lift_target - lift_ref;
+  lift_ref += lift_vel * (int)frame_steps;
+  if ((err > 0 && lift_ref > lift_target) || (err < 0 && lift_ref < lift_target))
+    lift_ref = lift_target;
+
+  /* Feed forward the profile speed, and catch up to the profile */
+  err = lift_ref - encoders.otis * 16;
+  if (lift_ref == lift_target && lift_vel == 0 &&
+      err <= LIFT_TOLERANCE * 16 && err >= -LIFT_TOLERANCE * 16)
+  {
+    lift = 127;
+    lift_moving = 0;
+    return;
+  }
+  out = (lift_vel * LIFT_KV) / 16 + (err * LIFT_KP) / 16;
+  if (out > 0 && out < lift_creep)
+    out = lift_creep;       /* anything less won't move it */
+  if (out < 0 && out > -lift_creep)
+    out = -lift_creep;
+  if (out > lift_speed_up - 127)
+    out = lift_speed_up - 127;
+  if (out < lift_speed_down - 127)
+    out = lift_speed_down - 127;
+
+  if ((out > 0 && lift_high == CLOSED) || (out < 0 && lift_bottom == CLOSED))
+  {
+    lift = 127;             /* at a limit switch, can't go further */
+    lift_moving = 0;
+    return;
+  }
+  lift = 127 + out;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Lift_Buttons
+* PURPOSE:       Starts a move when a port 4 button is pressed.  Moving the
+*                lift switch (p3_x) takes the lift back by hand.
+*                  p4_sw_trig   bottom
+*                  p4_sw_top    side goal
+*                  p4_sw_aux1   center goal
+*                  p4_sw_aux2   max
+* CALLED FROM:   user_routines.c, Default_Routine
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Lift_Buttons(void)
+{
+  if (in_rise[IN_OI_B] & IN_P4_TRIG)
+    Lift_Go_To(LIFT_PRESET_BOTTOM);
+  if (in_rise[IN_OI_B] & IN_P4_TOP)
+    Lift_Go_To(LIFT_PRESET_SIDE);
+  if (in_rise[IN_OI_B] & IN_P4_AUX1)
+    Lift_Go_To(LIFT_PRESET_CENTER);
+  if (in_rise[IN_OI_B] & IN_P4_AUX2)
+    Lift_Go_To(LIFT_PRESET_MAX);
+
+  if (p3_x > 200 || p3_x < 30)    /* same thresholds as lift_operate */
+    Lift_Stop();
+}
@@ -0,0 +1,45 @@
+/*******************************************************************************
+* FILE NAME: user_lift.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_lift.c
+*  It contains the preset heights and the motion profile for the lift.
+*
+* USAGE:
+*  Heights are otis clicks up from the bottom limit switch.  Measure
+*  LIFT_SIDE_CLICKS and LIFT_CENTER_CLICKS on the robot by raising the lift
+*  to each goal and reading "ht" off the telemetry.
+*******************************************************************************/
+#ifndef __user_lift_h_
+#define __user_lift_h_
+
+/* Presets, for Lift_Go_To and AS_LIFT_TO */
+#define LIFT_PRESET_BOTTOM  0
+#define LIFT_PRESET_SIDE    1
+#define LIFT_PRESET_CENTER  2
+#define LIFT_PRESET_MAX     3
+#define LIFT_PRESETS        4
+
+#define LIFT_SIDE_CLICKS    62    /* side goal, measure this */
+#define LIFT_CENTER_CLICKS  88    /* center goal, measure this */
+
+/* Profile, Q4 clicks (16 = 1 click) and Q4 clicks per frame */
+#define LIFT_VMAX           48    /* 3 clicks a frame, about full speed */
+#define LIFT_ACCEL          4     /* full speed in 12 frames, about 0.3s */
+
+/* PWM counts from neutral */
+#define LIFT_KV             20    /* per click a frame of profile speed */
+#define LIFT_KP             6     /* per click the lift is behind the profile */
+#define LIFT_TOLERANCE      2     /* clicks, close enough to call it there */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_lift.c */
+void Lift_Go_To(unsigned char preset);
+void Lift_Stop(void);
+unsigned char Lift_Moving(void);
+void Lift_Run(void);
+void Lift_Buttons(void);
+
+#endif
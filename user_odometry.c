@@ -0,0 +1,227 @@
+/*******************************************************************************
+* FILE NAME: user_odometry.c
+*
+* DESCRIPTION:
+*  This file contains dead reckoning for the drive base.  Every control frame
+*  the left and right wheel ticks from user_encoder.c are turned into a
+*  distance and a heading change, and the pose is moved along the average
+*  heading of the frame.  Everything is fixed point:
+*     position   inches in Q8 (long)
+*     heading    binary angle, 65536 counts per turn (unsigned int)
+*     sin/cos    Q14, from a 65 entry quarter wave table
+*  One update is two long multiplies plus a few table reads.
+*
+* USAGE:
+*  Odometry_Update must run right after Encoder_Update in every frame.
+*  Odometry_Heading_To and Odometry_Distance_To tell autonomous code which
+*  way to turn and how far to go to reach a point.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_frame.h"
+#include "user_input.h"
+#include "user_arena.h"
+
+/* sin(i * 90 / 64 degrees) in Q14 */
+static rom const int odo_sin_table[65] =
+{
+      0,   402,   804,  1205,  1606,  2006,  2404,  2801,
+   3196,  3590,  3981,  4370,  4756,  5139,  5520,  5897,
+   6270,  6639,  7005,  7366,  7723,  8076,  8423,  8765,
+   9102,  9434,  9760, 10080, 10394, 10702, 11003, 11297,
+  11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+  13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+  15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+  16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+  16384
+};
+
+/* atan(i / 32) as a binary angle, covers the first octant */
+static rom const unsigned int odo_atan_table[33] =
+{
+      0,   326,   651,   975,  1297,  1617,  1933,  2246,
+   2555,  2860,  3159,  3453,  3742,  4025,  4302,  4572,
+   4836,  5094,  5344,  5589,  5826,  6058,  6282,  6500,
+   6712,  6917,  7117,  7310,  7498,  7679,  7856,  8026,
+   8192
+};
+
+/*******************************************************************************
+* FUNCTION NAME: Odometry_Reset
+* PURPOSE:       Puts the robot at a known spot on the field.
+* CALLED FROM:   user_routines_fast.c, User_Autonomous_Init, or anywhere
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     x, y           int              I    position in inches
+*     heading        unsigned int     I    binary angle, use ODO_DEG()
+* RETURNS:       void
+*******************************************************************************/
+void Odometry_Reset(int x, int y, unsigned int heading)
+{
+  pose.x = (long)x << 8;
+  pose.y = (long)y << 8;
+  pose.heading = heading;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Odometry_Update
+* PURPOSE:       Moves the pose by one frame of wheel ticks.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Odometry_Update(void)
+{
+  int dist;                 /* Q8 inches travelled by the center this frame */
+  int turn;                 /* heading change this frame */
+  unsigned int mid;         /* heading half way through the frame */
+
+  if (encoders.left_rate == 0 && encoders.right_rate == 0)
+    return;
+
+  dist = (int)(((long)(encoders.left_rate + encoders.right_rate) * ODO_TICK_Q8) >> 1);
+  turn = (int)((long)(encoders.right_rate - encoders.left_rate) * ODO_BRADS_PER_TICK);
+
+  mid = pose.heading + (turn >> 1);
+  pose.x += ((long)dist * Odo_Cos(mid)) >> 14;
+  pose.y += ((long)dist * Odo_Sin(mid)) >> 14;
+  pose.heading += turn;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Odo_Sin
+* PURPOSE:       Sine of a binary angle, to the nearest 1.4 degrees.
+* CALLED FROM:   this file, anywhere
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     angle          unsigned int     I    binary angle
+* RETURNS:       int, Q14 (16384 = 1.0)
+*******************************************************************************/
+int Odo_Sin(unsigned int angle)
+{
+  unsigned char index;
+
+  angle += 128;                             /* round to the nearest entry */
+  index = (unsigned char)(angle >> 8) & 63;
+
+  switch (angle >> 14)                      /* quadrant */
+  {
+    case 0:
+      return odo_sin_table[index];
+    case 1:
+      return odo_sin_table[64 - index];
+    case 2:
+      return -odo_sin_table[index];
+    default:
+      return -odo_sin_table[64 - index];
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Odo_Cos
+* PURPOSE:       Cosine of a binary angle.
+* CALLED FROM:   this file, anywhere
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     angle          unsigned int     I    binary angle
+* RETURNS:       int, Q14 (16384 = 1.0)
+*******************************************************************************/
+int Odo_Cos(unsigned int angle)
+{
+  return Odo_Sin(angle + 16384);
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Odo_Atan2
+* PURPOSE:       Direction of the vector (dx, dy), folded into the first
+*                octant and looked up in odo_atan_table.
+* CALLED FROM:   this file, anywhere
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     dy, dx         long             I    vector, any matching units
+* RETURNS:       unsigned int, binary angle
+*******************************************************************************/
+unsigned int Odo_Atan2(long dy, long dx)
+{
+  long ax;
+  long ay;
+  unsigned int angle;
+
+  ax = (dx < 0) ? -dx : dx;
+  ay = (dy < 0) ? -dy : dy;
+
+  if (ax == 0 && ay == 0)
+    return 0;
+
+  if (ay <= ax)
+    angle = odo_atan_table[(unsigned char)(((ay << 5) + (ax >> 1)) / ax)];
+  else
+    angle = 16384 - odo_atan_table[(unsigned char)(((ax << 5) + (ay >> 1)) / ay)];
+
+  if (dx < 0)
+    angle = 32768 - angle;
+  if (dy < 0)
+    angle = 0 - angle;
+  return angle;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Odometry_Heading_To
+* PURPOSE:       How far to turn to face a point.
+* CALLED FROM:   autonomous code
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     x, y           int              I    point on the field in inches
+* RETURNS:       int, binary angle, positive means turn left
+*******************************************************************************/
+int Odometry_Heading_To(int x, int y)
+{
+  return (int)(Odo_Atan2(((long)y << 8) - pose.y, ((long)x << 8) - pose.x) - pose.heading);
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Odometry_Distance_To
+* PURPOSE:       Straight line distance to a point, using the alpha max plus
+*                beta min estimate (within 4%) instead of a square root.
+* CALLED FROM:   autonomous code
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     x, y           int              I    point on the field in inches
+* RETURNS:       unsigned int, inches
+*******************************************************************************/
+unsigned int Odometry_Distance_To(int x, int y)
+{
+  long dx;
+  long dy;
+  long big;
+  long small;
+
+  dx = ((long)x << 8) - pose.x;
+  dy = ((long)y << 8) - pose.y;
+  if (dx < 0) dx = -dx;
+  if (dy < 0) dy = -dy;
+
+  if (dx > dy)
+  {
+    big = dx;
+    small = dy;
+  }
+  else
+  {
+    big = dy;
+    small = dx;
+  }
+
+  return (unsigned int)(((big * 123) + (small * 51)) >> 15);  /* /128, then Q8 */
+}
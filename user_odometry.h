@@ -0,0 +1,50 @@
+/*******************************************************************************
+* FILE NAME: user_odometry.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_odometry.c
+*  It contains the robot pose and the fixed point helpers used to steer
+*  towards a point on the field.
+*
+* USAGE:
+*  Robot geometry (wheel_diameter, banner_stripes, track_width) is set in
+*  user_routines.h.  Field coordinates are in inches from where the robot
+*  was when Odometry_Reset was called, +x straight ahead and +y to the left.
+*******************************************************************************/
+#ifndef __user_odometry_h_
+#define __user_odometry_h_
+
+/* Binary angles: a full turn is 65536, so unsigned int math wraps for free */
+#define ODO_DEG(d)          ((unsigned int)(((long)(d) * 65536L) / 360L))
+
+/* Wheel ticks per revolution, both edges of every stripe are counted */
+#define ODO_TICKS_PER_REV   (2 * banner_stripes)
+
+/* Distance for one tick in Q8 inches, pi is 355/113 */
+#define ODO_TICK_Q8         ((355L * 256L * wheel_diameter) / (113L * ODO_TICKS_PER_REV))
+
+/* Heading change for one tick of difference between the wheels (pi cancels) */
+#define ODO_BRADS_PER_TICK  ((65536L * wheel_diameter) / (2L * ODO_TICKS_PER_REV * track_width))
+
+typedef struct
+{
+  long x;                   /* inches in Q8 (256 = 1 inch) */
+  long y;                   /* inches in Q8 */
+  unsigned int heading;     /* binary angle, counter clockwise is positive */
+} ODO_POSE;
+
+/* pose is in the hot state, see user_arena.h */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_odometry.c */
+void Odometry_Reset(int x, int y, unsigned int heading);
+void Odometry_Update(void);
+int Odo_Sin(unsigned int angle);
+int Odo_Cos(unsigned int angle);
+unsigned int Odo_Atan2(long dy, long dx);
+int Odometry_Heading_To(int x, int y);
+unsigned int Odometry_Distance_To(int x, int y);
+
+#endif
@@ -0,0 +1,91 @@
+/*******************************************************************************
+* FILE NAME: user_pool.c
+*
+* DESCRIPTION:
+*  This file contains a pool of fixed size RAM blocks for the serial buffers.
+*  Each serial port used to keep its own 80 byte transmit buffer, whether it
+*  was sending anything or not (the camera port never used its own), plus a
+*  32 byte buffer for Serial_Write.  Now a buffer is borrowed from here when
+*  something is sent and handed back by the transmit interrupt when the last
+*  byte has gone.
+*
+*  The free blocks are bits in one byte, so taking or giving back a block is
+*  a couple of bit operations, and at most POOL_BLOCKS tries to find a free
+*  bit.
+*
+* USAGE:
+*  Pool_Alloc and Pool_Free may be called from the main loop or the low
+*  priority interrupt.  They mask the low priority interrupt for a few
+*  instructions and put it back the way it was.  The high priority
+*  interrupt (the IFI library) never uses the pool.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_pool.h"
+
+unsigned char pool_ram[POOL_BLOCKS][POOL_BLOCK_SIZE];
+volatile unsigned char pool_in_use = 0;
+unsigned char pool_high_water = 0;
+unsigned char pool_failures = 0;
+
+static unsigned char pool_free_map = (1 << POOL_BLOCKS) - 1;  /* 1 = free */
+
+/*******************************************************************************
+* FUNCTION NAME: Pool_Alloc
+* PURPOSE:       Takes a free block.
+* CALLED FROM:   user_SerialDrv.c
+* ARGUMENTS:     none
+* RETURNS:       the block, or POOL_NONE if they are all in use
+*******************************************************************************/
+unsigned char Pool_Alloc(void)
+{
+  unsigned char peie;
+  unsigned char block;
+  unsigned char bit;
+
+  peie = INTCONbits.PEIE;
+  INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+
+  block = POOL_NONE;
+  if (pool_free_map)
+  {
+    for (block = 0, bit = 1; !(pool_free_map & bit); block++, bit <<= 1)
+      ;
+    pool_free_map &= ~bit;
+    if (++pool_in_use > pool_high_water)
+      pool_high_water = pool_in_use;
+  }
+  else pool_failures++;
+
+  INTCONbits.PEIE = peie;       /* as it was, it's off in the interrupt */
+  return block;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Pool_Free
+* PURPOSE:       Gives a block back.
+* CALLED FROM:   user_SerialDrv.c, including Process_TX in the interrupt
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     block          unsigned char    I    from Pool_Alloc, POOL_NONE is ok
+* RETURNS:       void
+*******************************************************************************/
+void Pool_Free(unsigned char block)
+{
+  unsigned char peie;
+
+  if (block >= POOL_BLOCKS)
+    return;
+
+  peie = INTCONbits.PEIE;
+  INTCONbits.PEIE = 0;          /* Disable low priority interrupts */
+  if (!(pool_free_map & (1 << block)))
+  {
+    pool_free_map |= 1 << block;
+    pool_in_use--;
+  }
+  INTCONbits.PEIE = peie;
+}
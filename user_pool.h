@@ -0,0 +1,35 @@
+/*******************************************************************************
+* FILE NAME: user_pool.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_pool.c
+*  It contains the size of the buffer pool.
+*
+* USAGE:
+*  Watch pool_high_water in the telemetry.  If it never gets to POOL_BLOCKS,
+*  POOL_BLOCKS can come down by the difference and the RAM goes back to the
+*  rest of the program.  pool_failures should stay at 0.
+*******************************************************************************/
+#ifndef __user_pool_h_
+#define __user_pool_h_
+
+#define POOL_BLOCK_SIZE 32      /* bytes per block */
+#define POOL_BLOCKS     4       /* up to 8, one bit each in the free map */
+#define POOL_NONE       0xFF    /* no block */
+
+/* Where a block is in RAM */
+#define Pool_Ptr(block)   (&pool_ram[(block)][0])
+
+extern unsigned char pool_ram[POOL_BLOCKS][POOL_BLOCK_SIZE];
+extern volatile unsigned char pool_in_use;  /* blocks handed out now */
+extern unsigned char pool_high_water;   /* most ever handed out at once */
+extern unsigned char pool_failures;     /* Pool_Alloc found none free */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_pool.c */
+unsigned char Pool_Alloc(void);
+void Pool_Free(unsigned char block);
+
+#endif
@@ -19,15 +19,27 @@
 #include "user_routines.h"
 #include "user_Serialdrv.h"
 #include "user_camera.h"
+#include "user_scheduler.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_heading.h"
+#include "user_eeprom.h"
+#include "user_lift.h"
+#include "user_shoulder.h"
+#include "user_input.h"
+#include "user_frame.h"
+#include "user_arena.h"
+#include "user_stack.h"
 
 
 extern unsigned char aBreakerWasTripped;
 
 /*
- * This is our persistent profile. It survives a power-off.
+ * These are our factory settings, used until a profile has been saved in
+ * the data EEPROM (see user_eeprom.c).
  */
 #pragma romdata MHS166_PROFILE
-const rom struct mhs166_profile saved_profile = {0, 1, 2, 3}; /* Factory settings */
+const rom struct mhs166_profile saved_profile = {{0, 1, 2}, 3, {128, 102, 102, 128}}; /* Factory settings */
 
 #pragma romdata
 
@@ -36,6 +48,26 @@ const rom struct mhs166_profile saved_profile = {0, 1, 2, 3}; /* Factory setting
  */
 struct mhs166_profile volatile_profile;
 
+/*
+ * The on/off settings these routines keep from one frame to the next,
+ * packed a bit each.
+ */
+static struct
+{
+  unsigned int  in_autonomous:1;    /* set once autonomous has been started */
+  unsigned int  drive_override:1;   /* p1_sw_top took off the drive ramp */
+  unsigned int  one_stick:1;        /* switch_joystick, 1 stick drive */
+  unsigned int  shoulder_auto:1;    /* p3_y sets the shoulder, not the switch */
+  unsigned int  :4;
+} user_flags;
+
+/*
+ * Boot timing, in scheduler ticks (ms) from Scheduler_Initialize.  Nothing
+ * before that in User_Initialization takes more than a few microseconds.
+ */
+unsigned int boot_ready_ms;         /* User_Proc_Is_Ready */
+unsigned int boot_first_frame_ms;   /* first Putdata answering the master uP */
+
 /*******************************************************************************
 * FUNCTION NAME: User_Initialization
 * PURPOSE:       This routine is called first (and only once) in the Main function.  
@@ -96,6 +128,10 @@ void User_Initialization (void)
 
   Putdata(&txdata);             /* DO NOT CHANGE! */
   Serial_Driver_Initialize();
+  Scheduler_Initialize();       /* start the 1ms tick, see user_scheduler.c */
+  Encoder_Initialize();         /* wheel tick interrupts, see user_encoder.c */
+  Heading_Hold_Reset();         /* see user_heading.c */
+  Eeprom_Initialize();          /* find the saved profile, see user_eeprom.c */
 	
   //printf("IFI 2005 User Processor Initialized ...\r");  /* Optional - Print initialization message. */
   /* Note:  use a '\r' rather than a '\n' with the new compiler (v2.4) */
@@ -104,27 +140,50 @@ void User_Initialization (void)
 //  cam_state_flag = 0;
 #endif
   activate_profile();
+  boot_ready_ms = Scheduler_Get_Ticks();
   User_Proc_Is_Ready();         /* DO NOT CHANGE! - last line of User_Initialization */
 }
 
 /*******************************************************************************
 * FUNCTION NAME: Process_Data_From_Master_uP
 * PURPOSE:       Executes every 26.2ms when it gets new data from the master 
-*                microprocessor.
-* CALLED FROM:   main.c
+*                microprocessor.  In autonomous mode it runs one frame of the
+*                selected autonomous routine instead of Default_Routine.
+* CALLED FROM:   user_scheduler.c, Scheduler_Run
 * ARGUMENTS:     none
 * RETURNS:       void
 *******************************************************************************/
 void Process_Data_From_Master_uP(void)
 {
   static unsigned char i;
-  static unsigned char delay;
 
   Getdata(&rxdata);   /* Get fresh data from the master microprocessor. */
+  Frame_Latch();      /* inputs for this frame, see user_frame.c */
+  Scheduler_Frame_Check(frame_steps);	//late? shed background work
+  Encoder_Update();   /* wheel counts for this frame */
+  Odometry_Update();  /* and where they moved us */
+  Drive_Calibrate();  /* learn the drive gains from how we drove last frame */
 
-  Default_Routine();  /* Optional.  See below. */
-
-  Generate_Pwms(pwm13,pwm14,pwm15,pwm16);
+  if (autonomous_mode)            /* DO NOT CHANGE! */
+  {
+    if (!user_flags.in_autonomous)
+    {
+      User_Autonomous_Init();     /* first autonomous frame */
+      user_flags.in_autonomous = 1;
+    }
+    User_Autonomous_Code();       /* You edit this in user_routines_fast.c */
+  }
+  else
+  {
+    user_flags.in_autonomous = 0;
+#if ARENA_PROFILE
+    Arena_Profile_Start();
+#endif
+    Default_Routine();  /* Optional.  See below. */
+#if ARENA_PROFILE
+    Arena_Profile_Stop();
+#endif
+  }
 
   /* Eample code to check if a breaker was ever tripped. */
 
@@ -137,9 +196,14 @@ void Process_Data_From_Master_uP(void)
                             Normally, you do something else if a breaker got tripped (ex: limit a PWM output)     */
     }
   }
+  User_Byte2 = Serial_Error_Byte();	//UART receive errors, camera and breaker panel
 
-
+  Frame_Commit();     /* relays, everything else goes out in txdata */
+  Generate_Pwms(pwm13,pwm14,pwm15,pwm16);
   Putdata(&txdata);             /* DO NOT CHANGE! */
+  if (!boot_first_frame_ms)
+    boot_first_frame_ms = Scheduler_Get_Ticks() | 1;	//never 0 once set
+  Encoder_Set_Direction();	//count the wheels the way we are now driving them
 }
 
 /*******************************************************************************
@@ -153,10 +217,8 @@ void Process_Data_From_Master_uP(void)
 void Default_Routine(void)
 {
 	float speed_reduction = .5;		//this is used to store the reduction value for the joysticks
-	static int L_last_drive_value = 127;
-	static int R_last_drive_value = 127;
-	static unsigned char override_on_off = 0;
-	static unsigned char prev_p1_sw_top = 0;
+	static unsigned char L_last_drive_value = 127;
+	static unsigned char R_last_drive_value = 127;
 	
 	/*This next section of code is used to change the type of joystick control.
 	This can be changed by using p1_sw_aux1 to start this function. Other
@@ -181,18 +243,15 @@ void Default_Routine(void)
 #if 1
 		if(!lift_bottom)
 			{
-			set_drive_L(gain(p2_y, speed_reduction));
-			set_drive_R(gain(p1_y, speed_reduction));
+			set_drive_assist(gain(p2_y, speed_reduction), gain(p1_y, speed_reduction));
 			}
 		else if(p2_sw_trig)
 				{
-			set_drive_L(gain(p2_y, speed_reduction));
-			set_drive_R(gain(p1_y, speed_reduction));
+			set_drive_assist(gain(p2_y, speed_reduction), gain(p1_y, speed_reduction));
 				}
 		else	
 			{
-			set_drive_L(gain(p2_y, .5));
-			set_drive_R(gain(p1_y, .5));
+			set_drive_assist(gain(p2_y, .5), gain(p1_y, .5));
 //		/	printf("the left and right drives are %d %d\r", drive_L, drive_R);
 			}	
 		}
@@ -203,20 +262,18 @@ void Default_Routine(void)
 
 			if(!lift_bottom)
 				{
-				override_on_off = 0;
+				user_flags.drive_override = 0;
 				set_drive_L(acceleration(gain(p2_y, speed_reduction),L_last_drive_value,1,1));
 				set_drive_R(acceleration(gain(p1_y, speed_reduction),R_last_drive_value,2,1));
 				}
 				else
 					{
-						if ((p1_sw_top)&&(!prev_p1_sw_top))  // switch toggled
+						if (in_rise[IN_OI_A] & IN_P1_TOP)  // switch toggled
 							{
-								if (override_on_off == 0)
-									override_on_off = 1;
-								else override_on_off = 0;
+								user_flags.drive_override = !user_flags.drive_override;
 							}
 
-									if (((override_on_off == 0)&&(p1_sw_trig == 1)) || override_on_off == 1)
+									if (((user_flags.drive_override == 0)&&(p1_sw_trig == 1)) || user_flags.drive_override == 1)
 									{
 									set_drive_L(acceleration(gain(p2_y, speed_reduction),L_last_drive_value,1,1));
 									set_drive_R(acceleration(gain(p1_y, speed_reduction),R_last_drive_value,2,1));
@@ -229,7 +286,6 @@ void Default_Routine(void)
 				}
 		L_last_drive_value = p2_y;
 		R_last_drive_value = p1_y;
-		prev_p1_sw_top = p1_sw_top;
 		}
 
 #endif
@@ -248,11 +304,13 @@ void Default_Routine(void)
 					set_drive_L(gain(p1_y + p1_x - 127, speed_reduction));
 					}
 #endif
-	lift_operate(p3_x);			//operatates otis
+	Lift_Buttons();				//p4 buttons pick a preset height
+	if(Lift_Moving())
+		Lift_Run();				//going to the preset
+	else lift_operate(p3_x);	//operatates otis
 	gripper_control();				//operates the gripper
 	shoulder_control();				//operates the arm extension
 	pressure_control();				//operators the compressor
-	otis_height_counter();
 
 	#if _USE_CMU_CAMERA
   	return;     //Don't execute the ROBOT FEEDBACK if the CMU camera is used
@@ -275,7 +333,11 @@ void Default_Routine(void)
   
   else  /* User Mode is On - displays data in OI 4-digit display*/
   {
+#if STACK_ON_OI
+    User_Mode_byte = Stack_Display();	/* deepest the software stack has been, in bytes */
+#else
     User_Mode_byte = backup_voltage*10; /* so that decimal doesn't get truncated. */
+#endif
   }   
   
 } /* END Default_Routine(); */
@@ -294,14 +356,17 @@ unsigned char gain(int input, float reduction)
 
 /************SET_DRIVE FUNCTIONS***********/
 /*These functions are used to set the drive on the robot. There is one for
-the left drive wheel and the right drive wheel.*/
+the left drive wheel and the right drive wheel. Each side and direction has its
+own gain in the profile (128 is full power), learned by Drive_Calibrate, so the
+stronger motor is turned down to match the weaker one. This used to be a fixed
+0.80 motor_bal. It is one 8x8 hardware multiply per side.*/
 void set_drive_L(int speed)
 {
 //printf("in set left drive function input is %d\r", speed);
 
 	if(speed < 127)
-		drive_L = ((speed - 127) * motor_bal + 127);//gain(speed, motor_bal);			//ensures we are not over 254.											//sets left drive to speed
-	else drive_L = speed;						//set to highest value
+		drive_L = 127 - scale_drive(127 - speed, volatile_profile.drive_gain[GAIN_L_REV]);
+	else drive_L = 127 + scale_drive(speed - 127, volatile_profile.drive_gain[GAIN_L_FWD]);
 }
 
 /*******************/
@@ -309,10 +374,42 @@ void set_drive_R(int speed)
 {
 //printf("in set right drive function input is %d\r", speed);
 
-	if(speed > 127)
-		drive_R = ((speed - 127) * motor_bal + 127);	//ensure we are not over 254								//sets right drive to speed
-	else drive_R = speed;					//set to highest speed
+	if(speed < 127)
+		drive_R = 127 - scale_drive(127 - speed, volatile_profile.drive_gain[GAIN_R_REV]);
+	else drive_R = 127 + scale_drive(speed - 127, volatile_profile.drive_gain[GAIN_R_FWD]);
+}
+
+/*******************/
+/*Scales how far from neutral we want to drive by a gain, 128 = 1.0*/
+unsigned char scale_drive(int offset, unsigned char drive_gain)
+{
+	unsigned int scaled;
+
+	if(offset > 127)
+		offset = 127;
+	scaled = ((unsigned int)(unsigned char)offset * drive_gain) >> 7;	//8x8 multiply
+	if(scaled > 127)
+		scaled = 127;
+	return scaled;
+}
+
+/*******************set_drive_assist*********************
+When the driver has both sticks in the same place they want to go straight, so
+let the heading hold keep us straight. Otherwise drive each side as asked.*/
+void set_drive_assist(int left, int right)
+{
+#if HEADING_ASSIST
+	if(left != 127 && left - right <= HEADING_ASSIST_BAND && right - left <= HEADING_ASSIST_BAND)
+		{
+		Heading_Hold((left + right) / 2);
+		return;
+		}
+#endif
+	Heading_Hold_Release();
+	set_drive_L(left);
+	set_drive_R(right);
 }
+
 /***************   lift_operate     *******************
 Parameters: int input	input value for the function.
 Input: p3_x, set number, p3_sw_aux2	Range: 0-254, 0-254, 0 or 1 
@@ -337,42 +434,56 @@ void lift_operate(unsigned char input)
 	if(input > 200)	//is input greater than 127?
 		{
 		if(lift_high)	//are we already at the max bottom?
-			lift = lift_speed_up;	//send the lift up
+			lift = lift_soft_limit(lift_speed_up, lift_max - encoders.otis);	//send the lift up
 		else lift = 127;
 		}
 	else if(input < 30)	//is input less than 127?
 		{
 		if(lift_bottom)		//are we are max bottom?
-			lift = lift_speed_down;	//move lift down
+			lift = lift_soft_limit(lift_speed_down, encoders.otis);	//move lift down
 		else lift = 127;
 		}
 	else lift = 127;
 }
 
+/***************   lift_soft_limit     *******************
+Slows the lift down as it gets near the end of its travel, so it doesn't slam
+into the limit switch. Once the lift has been to the bottom since power up we
+know where it is from the otis counter; before that it just runs at full speed.
+At the top it stops at lift_max even if lift_high hasn't closed. At the bottom
+it creeps until lift_bottom closes, which is what zeroes the count.*/
+unsigned char lift_soft_limit(unsigned char speed, int clicks_left)
+{
+	int offset;
+
+	if(!lift_homed || clicks_left >= lift_slow_zone)
+		return speed;
+	if(speed > 127 && clicks_left <= 0)
+		return 127;		//soft top limit
+	if(clicks_left < 0)
+		clicks_left = 0;
+
+	offset = ((int)speed - 127) * clicks_left / lift_slow_zone;
+	if(speed > 127 && offset < lift_creep)
+		offset = lift_creep;
+	if(speed < 127 && offset > -lift_creep)
+		offset = -lift_creep;
+	return 127 + offset;
+}
+
 /********************  switch_joystick  ***********************/
 /* This function is used to change the type of drive the robot uses. The
 operator can change between 1 and 2 stick drive by using p1_sw_top*/
 int switch_joystick(void)
 {
-	static char already_shifted = 0;  //keeps track of whether or not
-                                   //the trigger has been pressed. 1 = changed value
-	static char current_gear = 0;			   //This keeps track of what gear the 
-							  	   //robot is currently in. Starts in high
-								   //gear.
-
-	if (p1_sw_aux2 && p1_sw_trig & !already_shifted)
+	/*both held, and one of them just pressed*/
+	if ((in_now[IN_OI_A] & (IN_P1_AUX2 | IN_P1_TRIG)) == (IN_P1_AUX2 | IN_P1_TRIG) &&
+		(in_rise[IN_OI_A] & (IN_P1_AUX2 | IN_P1_TRIG)))
 	{
-		if (current_gear == 0)				   //if currently in 2 stick
-			current_gear = 1;				   //change to 1 stick
-    	else current_gear = 0;				   //the robot must be in 1 stick
-	  					        		   //so change to 2 stick
- 		already_shifted = 1;           //tells program that gear has shifted
+		user_flags.one_stick = !user_flags.one_stick;	//2 stick to 1 stick, or back
 	}
 
-		if (!p1_sw_trig) 			//is the switch not pressed?
-	  		already_shifted = 0;             //if so, reset already_shifted
-  	
-	return current_gear;	//return current_gear
+	return user_flags.one_stick;	//1 for 1 stick drive
 }
 
 /********************  gripper_control  ***********************
@@ -390,40 +501,33 @@ complete. When the operator presses the switch, it will release for a
 
 int gripper_control(void)
 {
-
-	static char prev_p3_sw_trig = 0;
-
-
-	if (p3_sw_trig == 1 && p3_sw_trig != prev_p3_sw_trig )
+	if (in_rise[IN_OI_A] & IN_P3_TRIG)
 			{
 			gripper_in = 0;
 			gripper_extended = 1;
 			}
-	else if (p3_sw_trig == 0 && p3_sw_trig != prev_p3_sw_trig)
+	else if (in_fall[IN_OI_A] & IN_P3_TRIG)
 			{
 			gripper_extended = 0;
 			gripper_in = 1; 
 			}	 
-
-	if (p3_sw_trig == prev_p3_sw_trig)
+	else
 	{
 	gripper_extended = 0;
 	gripper_in = 0;
 	}
 
-	prev_p3_sw_trig = p3_sw_trig;
-
 }
 /*******************SHOULDER_control*******************************/
 /*Parameters: none
 Input: p3_y, p3_sw_aux1			Range: 0-254, 0 or 1
 Output: 0-255
 This function inputs the necessary information then passes this value, called raw_data,
-through this equation:
+through this equation (a table in user_shoulder.c):
  ((raw_data * 235) / 100) + 200;
- The computed value is compared to the input value from the potentiometer on the robot. 
-If we are not in the dead zone, which ranges 40, then the robot will move the shoulder
- up or down in order to cause the values to fall within the dead zone. This function 
+ The computed value is where the potentiometer on the robot should be, and the
+PID in user_shoulder.c moves the shoulder there, slowing down as it gets close
+ instead of running full speed in and out of a dead zone. This function 
 also incorporates an emergency manual switch. This will allow p3_sw_top to toggle between 
 use of the pot and pure manual. This is used when the pot is not working correctly.
  In both modes, the operator has the choice of slowing the arm to 50% power by pressing 
@@ -432,39 +536,20 @@ and holding p3_sw_aux1. The power reduction is achieved by use of the gain funct
 
 void shoulder_control(void)
 {
-	int input;						//holds input from the pot on the arm
-	unsigned int translated = 0;	//translated value from the oi
-	static char mode = 0;			//current mode, auto or manual
-	static char mode_db = 0;		//debounce
-
-	if (p3_sw_top && !mode_db)		//if p3_sw_top and not debonce
+	if (in_rise[IN_OI_A] & IN_P3_TOP)		//if p3_sw_top was just pressed
 	{
-	/*switch mode to the opposent setting and make the debounce 1*/
-		if (mode)					
-			mode = 0;
-		else mode = 1;
-
-	mode_db = 1;	
+	/*switch mode to the opposent setting*/
+		user_flags.shoulder_auto = !user_flags.shoulder_auto;
 	}
 
-	if(!p3_sw_top)		//if the top switch is not pressed
-		mode_db = 0;	//set debounce to 0
-
-	input = Get_Analog_Value(shoulder_pot);		//input value from the sensor on robot
 	Pwm1_green = 0;		//single for mode of arm
-	if(mode)
+	if(user_flags.shoulder_auto)
 	{
-		translated = ((2.35 * raw_data) + 200);
-
-			if(translated <= input + shoulder_dead_zone && translated >= input - shoulder_dead_zone)
-				shoulder = 127;
-			else if(translated < input - shoulder_dead_zone)
-					shoulder = shoulder_speed_down;
-				else if(translated > input + shoulder_dead_zone)
-					shoulder = shoulder_speed_up;
+		shoulder = Shoulder_PID(Shoulder_Setpoint(raw_data));
 	}
 	else 
 	{
+		Shoulder_Reset();	//start clean when the pot takes over again
 		if(raw_data > 200)
 			shoulder = shoulder_speed_up;
 		else if (raw_data < 50)
@@ -492,44 +577,15 @@ void pressure_control(void)
     	else compressor = 0;
 }
 
-/***************************otis_height_counter
-This function is used to dermine the height of otis. */
-void otis_height_counter(void)
-{
-#if 0
-	static char last_val = 0;		//last value from lift 
-	static unsigned char mag_count = 1;
-	
-	if(lift > 127)					//if the lift is going down
-	{
-		if(otis_counter != last_val)
-			{				
-			mag_count++;
-			last_val = otis_counter;
-			} 
-	}
-
-	if(lift < 127)
-	{
-		if(otis_counter != last_val)
-			{
-			mag_count--;
-			last_val = otis_counter;
-			}
-	}
-#endif
-}
-
-
 int acceleration( int drive_value, int last_drive_value, unsigned char RorL,unsigned char override)
 {
 
-static int R_limit_tick = 0;
-static int L_limit_tick = 0;
-static int R_new_drive_value = 127;
-static int L_new_drive_value = 127;
-static int R_old_speed = 127;
-static int L_old_speed = 127;
+static unsigned char R_limit_tick = 0;		//frames into the ramp, up to acceleration_limit_max
+static unsigned char L_limit_tick = 0;
+static unsigned char R_new_drive_value = 127;	//PWMs, 0 - 254
+static unsigned char L_new_drive_value = 127;
+static unsigned char R_old_speed = 127;
+static unsigned char L_old_speed = 127;
 
 
 if (RorL == 1)   // Left side
@@ -543,8 +599,8 @@ if (RorL == 1)   // Left side
 		}
 		if (L_limit_tick <acceleration_limit_max)
 		{
-			L_new_drive_value = ((((100*(drive_value-L_old_speed))/acceleration_limit_max)*L_limit_tick)/100)+L_old_speed;
-			L_limit_tick = L_limit_tick++;
+			L_new_drive_value = ((((100*(drive_value-(int)L_old_speed))/acceleration_limit_max)*(int)L_limit_tick)/100)+L_old_speed;
+			L_limit_tick++;
 		}
 		else L_new_drive_value = drive_value;
 	}
@@ -568,8 +624,8 @@ else  // know that RorL == 2  Right side
 	
 		if (R_limit_tick <acceleration_limit_max)
 		{
-			R_new_drive_value = ((((100*(drive_value-R_old_speed))/acceleration_limit_max)*R_limit_tick)/100)+R_old_speed;
-			R_limit_tick = R_limit_tick++;
+			R_new_drive_value = ((((100*(drive_value-(int)R_old_speed))/acceleration_limit_max)*(int)R_limit_tick)/100)+R_old_speed;
+			R_limit_tick++;
 		}
 		else R_new_drive_value = drive_value;
 	}
@@ -592,19 +648,20 @@ else  // know that RorL == 2  Right side
  */
 void activate_profile(void) {
 
-    /* Copy the persistent profile into our volatile */
+    /* Load the newest saved profile, or the factory settings if there isn't one */
     
-    memcpy((void *)&volatile_profile, (void *)&saved_profile,
-		sizeof(volatile_profile));
+    if (!Eeprom_Load((unsigned char *)&volatile_profile, sizeof(volatile_profile)))
+        memcpypgm2ram((void *)&volatile_profile, (const rom void *)&saved_profile,
+		    sizeof(volatile_profile));
 }
 
 /*
- * This routine saves our active profile.
+ * This routine saves our active profile. It only queues the write, and only
+ * if something changed, so it is fine to call it every loop.
  */
 void store_profile(void) {
 
-    memcpy((void *)&saved_profile, (void *)&volatile_profile,
-		sizeof(volatile_profile));
+    Eeprom_Store((const unsigned char *)&volatile_profile, sizeof(volatile_profile));
     
 }
 
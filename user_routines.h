@@ -16,18 +16,17 @@
 
 #define drive_L 	pwm01			//left drive motor
 #define drive_R 	pwm03			//right drive motor
-#define motor_bal	.80			//percent reduction for the reversed motor
 #define lift    	pwm05			//vertical lift/arm, also known as otis
 #define shoulder	pwm07			//elbow on th9 lift
-#define lift_bottom rc_dig_in08		//bottom limit switch on lift
-#define lift_high   rc_dig_in09	    //high limit switch on lift
-#define goal_side   rc_dig_in11		//goal height, side, limit switch
-#define goal_center rc_dig_in10		//goal height, center, limit switch
-#define otis_counter rc_dig_in14	//counter for otis height
-#define gripper_extended  relay1_fwd		//operates the solinoid for the gripper
-#define gripper_in	 relay2_fwd		//operates a solinoid for the gripper
-#define pressure_sensor rc_dig_in12	//sensor to watch pressure of system
-#define compressor		relay3_fwd	//compresser to increase pressure in system	
+#define lift_bottom frame_dig_in08		//bottom limit switch on lift
+#define lift_high   frame_dig_in09	    //high limit switch on lift
+#define goal_side   frame_dig_in11		//goal height, side, limit switch
+#define goal_center frame_dig_in10		//goal height, center, limit switch
+#define otis_counter rc_dig_in03	//RB4, otis height, counted on port B change in InterruptHandlerLow
+#define gripper_extended  frame_relay1_fwd		//operates the solinoid for the gripper
+#define gripper_in	 frame_relay2_fwd		//operates a solinoid for the gripper
+#define pressure_sensor frame_dig_in12	//sensor to watch pressure of system
+#define compressor		frame_relay3_fwd	//compresser to increase pressure in system	
 #define lift_speed_down 60			//speed lift moves down
 #define lift_speed_up	194			//speed lift moves up
 #define shoulder_range		10		//tolerence on the shoulder
@@ -39,17 +38,22 @@
 #define shoulder_speed_up	254		//speed up on shoulder
 #define shoulder_speed_down 0		//speed down on shoulder
 #define lift_max			108			//max number of clicks for the lift
+#define lift_slow_zone		20			//clicks from the ends of travel where the lift slows down
+#define lift_creep			20			//slowest the lift moves in the slow zone, PWM counts from neutral
 #define acceleration_limit_max 38	//time of acceleration ramp in code loops; 19 code loops is about .5 seconds
-#define L_banner			rc_dig_in15
-#define R_banner			rc_dig_in16
+#define L_banner			rc_dig_in01	//INT2 pin, counted in InterruptHandlerLow
+#define R_banner			rc_dig_in02	//INT3 pin, counted in InterruptHandlerLow
+#define wheel_diameter		6			//drive wheel diameter in inches, measure this
+#define banner_stripes		8			//stripes on each wheel, both edges are counted
+#define track_width			24			//inches between the left and right wheels, measure this
 /*autonomous slection stuff*/
 #define red_blue			1	//rc_dig_in07
 #define left_side			0	//rc_dig_in06
 #define right_side			1	//rc_dig_in05
-#define auto_mode_bit1		rc_dig_in01
-#define auto_mode_bit2		rc_dig_in02
-#define auto_mode_bit3		rc_dig_in03
-#define auto_mode_bit4		rc_dig_in04
+#define auto_mode_bit1		frame_dig_in15	//moved off INT2 for the left banner
+#define auto_mode_bit2		frame_dig_in16	//moved off INT3 for the right banner
+#define auto_mode_bit3		frame_dig_in14	//moved off RB4 for the otis counter
+#define auto_mode_bit4		frame_dig_in04
 
 /* Used in limit switch routines in user_routines.c */
 #define OPEN        1     /* Limit switch is open (input is floating high). */
@@ -63,8 +67,19 @@ struct mhs166_profile
 {
     unsigned char vision_tetra_rgb[3];       /* Color code for vision tetra */
 	unsigned char joystick_used;		//used to save what joystic mode the bot is in.
+	unsigned char drive_gain[4];		//learned drive motor gains, 128 = full power, see set_drive_L
 };
 
+/* Which drive_gain is which */
+#define GAIN_L_FWD	0
+#define GAIN_L_REV	1
+#define GAIN_R_FWD	2
+#define GAIN_R_REV	3
+#define GAIN_FULL	128
+
+
+extern unsigned int boot_ready_ms;        /* see user_routines.c */
+extern unsigned int boot_first_frame_ms;
 
 /*******************************************************************************
                            FUNCTION PROTOTYPES
@@ -77,8 +92,10 @@ void Default_Routine(void);
 unsigned char gain(int input, float reduction);		//modifies input value
 void set_drive_L(int speed);//set pwm value(speed) to left drive motor(s)
 void set_drive_R(int speed);//set pwm value(speed) to right drive motor(s)
+void set_drive_assist(int left, int right);//sets both sides, holds heading if they match
+unsigned char scale_drive(int offset, unsigned char drive_gain);//applies a drive gain
 void lift_operate(unsigned char input);         //moves lift up or down
-void otis_height_counter(void);		//used to rocord height of otis
+unsigned char lift_soft_limit(unsigned char speed, int clicks_left);	//slows the lift near the ends
 int switch_joystick(void);          //changes 1 stick to 2 stick drive and vis versa
 int gripper_control(void);		//controls the gripper.
 void shoulder_control(void);		//this function is used to control the elbow
@@ -89,14 +106,11 @@ void store_profile(void);		//used to store our current profile
 
 /* These routines reside in user_routines_fast.c */
 void InterruptHandlerLow (void);  /* DO NOT CHANGE! */
+void User_Autonomous_Init(void);  /* called on the first autonomous frame */
 void User_Autonomous_Code(void);  /* Only in full-size FRC system. */
 void Process_Data_From_Local_IO(void);
-void User_Autonomous_Code_0(void);	//This is the do nothing autonomous mode
-void User_Autonomous_Code_1(void);	//This is the vision tetra to center goal AM
-void User_Autonomous_Code_2(void);	//This is vision tetra to side goal AM
-void User_Autonomous_Code_3(void);	//This is cap alliance center, hit hanging AM
-void User_Autonomous_Code_4(void);	//This is moving to the opponents side with tetra
-void User_Autonomous_Code_5(void);	//This is going to auto loading station
+void Sample_Sensors(void);		//1ms scheduler task
+void Telemetry_Task(void);		//20ms scheduler task
 
 
 #endif
@@ -18,31 +18,34 @@
 #include "ifi_utilities.h"
 #include "user_routines.h"
 #include "user_Serialdrv.h"
+#include "user_scheduler.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_autoscript.h"
+#include "user_heading.h"
+#include "user_eeprom.h"
+#include "user_shoulder.h"
+#include "user_frame.h"
+#include "user_pool.h"
+#include "user_input.h"
+#include "user_arena.h"
+#include "user_stack.h"
 #include <stdio.h>
 
+/* Set to 0 to stop the status lines on the program port */
+#define TELEMETRY_ENABLE 1
+#define TLM_LINES        10   /* Telemetry_Task turns, one line each */
+
 
 /*** DEFINE USER VARIABLES AND INITIALIZE THEM HERE ***/
 #if _USE_CMU_CAMERA
 #include "user_camera.h"
+#include "user_camlink.h"
 /****************************
 **   VISION VARIABLES      **
 *****************************/
-extern cam_struct cam;
-#if 0
-extern int speed_control;
-extern int speed_setting;
-#endif
-extern unsigned char cam_uart_buffer[];
-unsigned char char_buffer[2];  // 11
-volatile unsigned int data_rdy;
-volatile unsigned int cam_index_ptr = 0;  // Zero start of buffer
-unsigned int start_string;
-unsigned char rx_char;
-int packet_start = 0;                     // Used to parse packet types
-unsigned int parse_mode = 0;              // Tells it to look for '\r' instead of T packets
-int tracking, pan_position, tilt_position, drive_control = 0;
-int last_pan_position,begin_x, begin_y, end_y, i, j = 0;
-unsigned int transit_char,trcnt = 0;
+volatile cam_flagbits cam_flags;          // data_rdy and parse_mode, see user_camera.h
+volatile unsigned char cam_index_ptr = 0; // Zero start of buffer
 #endif
 
 /*******************************************************************************
@@ -81,19 +84,46 @@ void InterruptVectorLow (void)
 void InterruptHandlerLow ()     
 {                               
   unsigned char int_byte;       
+#if CAMERA_RX_FAST_LANE
+  if (RXINTF2 && RXINTE2)     /* camera byte, first so the UART FIFO can't overrun */
+  {
+    Camera_Rx_Fast();
+  }
+  else
+#endif
   if (INTCON3bits.INT2IF && INTCON3bits.INT2IE)       /* The INT2 pin is RB2/DIG I/O 1. */
   { 
     INTCON3bits.INT2IF = 0;
+    INTCON2bits.INTEDG2 = !L_banner;   /* interrupt again on the other edge */
+    enc_left_ticks += enc_left_dir;
   }
   else if (INTCON3bits.INT3IF && INTCON3bits.INT3IE)  /* The INT3 pin is RB3/DIG I/O 2. */
   {
     INTCON3bits.INT3IF = 0;
+    INTCON2bits.INTEDG3 = !R_banner;   /* interrupt again on the other edge */
+    enc_right_ticks += enc_right_dir;
   }
   else if (INTCONbits.RBIF && INTCONbits.RBIE)  /* DIG I/O 3-6 (RB4, RB5, RB6, or RB7) changed. */
   {
     int_byte = PORTB;          /* You must read or write to PORTB */
     INTCONbits.RBIF = 0;     /*     and clear the interrupt flag         */
-  }                                        /*     to clear the interrupt condition.  */
+                                           /*     to clear the interrupt condition.  */
+    if ((int_byte & 0x10) != enc_lift_last)   /* RB4 is the otis counter */
+    {
+      enc_lift_last = int_byte & 0x10;
+      enc_lift_ticks += enc_lift_dir;
+    }
+  }
+  else if (PIR3bits.TMR4IF && PIE3bits.TMR4IE)  /* 1ms scheduler tick */
+  {
+    PIR3bits.TMR4IF = 0;
+    sched_ticks++;
+  }
+  else if (PIR2bits.EEIF && PIE2bits.EEIE)    /* an EEPROM byte write finished */
+  {
+    PIR2bits.EEIF = 0;
+    Eeprom_Write_Done();
+  }
   else
   { 
     CheckUartInts();    /* For Dynamic Debug Tool or buffered printf features. */
@@ -102,98 +132,71 @@ void InterruptHandlerLow ()
 
 
 /*******************************************************************************
-* FUNCTION NAME: User_Autonomous_Code
-* PURPOSE:       Execute user's code during autonomous robot operation.
-* You should modify this routine by adding code which you wish to run in
-* autonomous mode.  It will be executed every program loop, and not
-* wait for or use any data from the Operator Interface.
-* CALLED FROM:   main.c file, main() routine when in Autonomous mode
+* FUNCTION NAME: User_Autonomous_Init
+* PURPOSE:       Set up for autonomous mode.  Neutralizes all outputs and reads
+*                the autonomous selection switches.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP, on the first
+*                frame of autonomous mode
 * ARGUMENTS:     none
 * RETURNS:       void
 *******************************************************************************/
-void User_Autonomous_Code(void)
-{
-
-int time_tick =0; // Counter of 26.2ms ticks since we got called
-int start_working =0; //the time in ticks when the autonomous mode starts
-unsigned char auto_selection; 	//autonomous selection
-char hold1;
-char hold2;
-char hold3;
-char hold4;
+static unsigned char auto_selection; 	//autonomous selection
 
+void User_Autonomous_Init(void)
+{
   /* Initialize all PWMs and Relays when entering Autonomous mode, or else it
      will be stuck with the last values mapped from the joysticks.  Remember, 
      even when Disabled it is reading inputs from the Operator Interface. 
   */
     pwm01 = pwm02 = pwm03 = pwm04 = pwm05 = pwm06 = pwm07 = pwm08 = 127;
     pwm09 = pwm10 = pwm11 = pwm12 = pwm13 = pwm14 = pwm15 = pwm16 = 127;
-    relay1_fwd = relay1_rev = relay2_fwd = relay2_rev = 0;
-    relay3_fwd = relay3_rev = relay4_fwd = relay4_rev = 0;
-    relay5_fwd = relay5_rev = relay6_fwd = relay6_rev = 0;
-    relay7_fwd = relay7_rev = relay8_fwd = relay8_rev = 0;
-
-	/* We assume the time_knob represents a setting of 0 through 7. Establish time,
-	   in ticks, when we should start working on autonomous code. Note that 500ms
-       is approximately 19 26.2ms ticks. Our time increments are in steps of approx 500ms.
-	*/
-	//start_working = time_knob * 19;
-
-
- //if (statusflag.NEW_SPI_DATA)      /* 26.2ms loop area */ 
-//		time_tick++;		//counter tick
-	
-
-//if (time_tick >= start_working) 	//the start of autonomous mode         
-//{		
+    frame_out.relay_fwd.allbits = 0;	//all relays off, sent by Frame_Commit
+    frame_out.relay_rev.allbits = 0;
+    Encoder_Reset();		//autonomous distances are measured from here
+    Odometry_Reset(0, 0, 0);	//and so is the field position
+    Heading_Hold_Reset();	//its marks were just zeroed, and start the I over
 
-hold1 = auto_mode_bit1;
-if(!hold1)
-	hold1 = 1;
-else hold1 = 0;
-
-hold2 = auto_mode_bit2;
-if(!hold2)
-	hold2 = 1;
-else hold2 = 0;
-
-hold3 = auto_mode_bit3;
-if(!hold3)
-	hold3 = 1;
-else hold3 = 0;
-
-hold4 = auto_mode_bit4;
-if(!hold4)
-	hold4 = 1;
-else hold4 = 0;
-
-//auto_selection = hold1 | (hold2 * 2) | (hold3 * 4) | (hold4 * 8);
+//the auto_mode switches read 0 when on:
+//auto_selection = !auto_mode_bit1 | (!auto_mode_bit2 << 1) | (!auto_mode_bit3 << 2) | (!auto_mode_bit4 << 3);
 auto_selection = 1;
+
 	switch(auto_selection)
 	{
-	case 0:
-	User_Autonomous_Code_0();
-	break;
 	case 1:
-	User_Autonomous_Code_1();
+	Autoscript_Start(auto_script_1);
 	break;
 	case 2:
-	User_Autonomous_Code_2();
+	Autoscript_Start(auto_script_2);
 	break;
 	case 3:
-	User_Autonomous_Code_3();
+	Autoscript_Start(auto_script_3);
 	break;
 	case 4:
-	User_Autonomous_Code_4();
+	Autoscript_Start(auto_script_4);
 	break;
 	case 5:
-	User_Autonomous_Code_5();
+	Autoscript_Start(auto_script_5);
 	break;
 	default:
-	User_Autonomous_Code_0();
+	Autoscript_Start(auto_script_0);
 	}
-//}
- 
+}
+
+/*******************************************************************************
+* FUNCTION NAME: User_Autonomous_Code
+* PURPOSE:       Execute user's code during autonomous robot operation.
+* This runs one 26.2ms frame of the autonomous script picked in
+* User_Autonomous_Init.  Getdata, Generate_Pwms and Putdata are done by
+* Process_Data_From_Master_uP, so the script engine does one frame of work
+* and returns, and the scheduler keeps the fast tasks running in between.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP when in
+*                Autonomous mode
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void User_Autonomous_Code(void)
+{
+	Autoscript_Step();
 }
 
 /*******************************************************************************
@@ -209,35 +212,114 @@ auto_selection = 1;
 void Process_Data_From_Local_IO(void)
 {
   /* Add code here that you want to be executed every program loop. */
+  Camera_Rx_Drain();    /* parse what the camera sent */
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Sample_Sensors
+* PURPOSE:       Execute user's sensor sampling code.
+* Add code here for sensors that need to be read more often than the master
+* uP sends packets.  Keep it short, it runs 1000 times a second.
+* CALLED FROM:   user_scheduler.c, every 1ms
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Sample_Sensors(void)
+{
+  /* Add code here that you want to be executed every millisecond. */
+  Shoulder_Sample();    /* average the shoulder pot */
+}
 
+/*******************************************************************************
+* FUNCTION NAME: Telemetry_Task
+* PURPOSE:       Prints the next of the status lines on the program port,
+*                one line a call, and none while the last one is still
+*                going out.  Every line fits in two pool blocks, so the
+*                printf never waits on the transmitter.  The TLM_LINES
+*                turns go round every 200ms.
+* CALLED FROM:   user_scheduler.c, every 20ms
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Telemetry_Task(void)
+{
+#if TELEMETRY_ENABLE
+  UART_ERRORS prog, cam;
+  static unsigned char boot_shown = 0;
+  static unsigned char tlm_line = 0;
+
+  if (Serial_Busy(PRINTF_PORT))
+    return;               /* try again next time, don't wait for it */
+
+  switch (tlm_line++)
+  {
+    case 0:
+      printf("TLM pkt %d L %d R %d lift %d ht %d sh %d\r", (int)rxdata.packet_num,
+        (int)drive_L, (int)drive_R, (int)lift, encoders.otis, (int)shoulder);
+      break;
+    case 1:
+      printf("POS enc %d %d x %d y %d hd %u\r", encoders.left, encoders.right,
+        (int)(pose.x >> 8), (int)(pose.y >> 8), pose.heading);
+      break;
+    case 2:
+      INTCONbits.PEIE = 0;    /* Disable low priority interrupts */
+      prog = uart_errors[PROGRAM_PORT];
+      cam = uart_errors[TTL_PORT];
+      INTCONbits.PEIE = 1;    /* Enable low priority interrupts */
+      /* receive errors, overrun/framing/recovered, and camera bytes dropped */
+      printf("SER pp %u/%u/%u cam %u/%u/%u drop %d\r",
+        prog.overruns, prog.framing, prog.recoveries,
+        cam.overruns, cam.framing, cam.recoveries, (int)cam_rx_dropped);
+      break;
+    case 3:
+      printf("POOL %d/%d fail %d STK %u/%d warn %d\r", (int)pool_high_water,
+        POOL_BLOCKS, (int)pool_failures, stack_high_water, STACK_SIZE,
+        (int)stack_warning);
+      break;
+    case 4:
+      printf("SHED level %d overruns %u events %u skipped %u\r", (int)sched_shed,
+        sched_overruns, sched_shed_events, sched_skipped);
+      break;
+    case 5:
+      printf("PKT drops %u gaps %u worst %d\r", frame_drops, frame_gaps,
+        (int)frame_gap_max);
+      break;
 #if _USE_CMU_CAMERA
-#if 0
-  if (speed_setting < 128 || speed_control > 254)   //Check speed_setting for valid forward speed
-    speed_setting = 150;            //If not valid number set to default
-  if (p1_sw_trig > 0){               // RUN ONLY IF TRIGGER IS HELD
-    if (tracking > 0)
-      speed_control = speed_setting;
-    else {
-      trcnt ++;
-      if (trcnt > 1000)
-        speed_control = 127;
-      else
-        trcnt = 0;
-    }
-  }
-  
-  if (tracking < 1 && p1_sw_trig < 1){
-    speed_control = 127;
-    pan_position = 127;
-  }
+    case 6:
+      printf("CAM link %d up %u fail %d back %d\r", (int)cam_link_state,
+        cam_link_ready_ms, (int)cam_link_failures, (int)cam_link_recoveries);
+      break;
+    case 7:
+      printf("CAM back in %u max %u\r", cam_link_recover_ms, cam_link_recover_max);
+      break;
 #endif
+#if ARENA_PROFILE
+    case 8:
+      printf("PRF dr %u max %u\r", arena_profile_cycles, arena_profile_max);
+      break;
+#endif
+    case 9:
+      if (!boot_shown && boot_first_frame_ms)
+      {
+        boot_shown = 1;       /* ms from Scheduler_Initialize */
+        printf("BOOT ready %u first frame %u\r", boot_ready_ms, boot_first_frame_ms);
+      }
+      else if (autonomous_mode)
+        printf("JNY part %d\r", (int)Journey_Part());   /* the speeds are on TLM */
+      break;
+    default:              /* a line that's compiled out, skip its turn */
+      break;
+  }
+  if (tlm_line >= TLM_LINES)
+    tlm_line = 0;
 #endif
 }
 
 /*******************************************************************************
 * FUNCTION NAME: Serial_Char_Callback
-* PURPOSE:       Interrupt handler for the TTL_PORT.
-* CALLED FROM:   user_SerialDrv.c
+* PURPOSE:       Parser for bytes from the TTL_PORT (the camera).
+* CALLED FROM:   user_SerialDrv.c, Camera_Rx_Drain from the main loop, or
+*                CheckUartInts from the interrupt if CAMERA_RX_FAST_LANE is 0
 * ARGUMENTS:     
 *     Argument             Type    IO   Description
 *     --------             ----    --   -----------
@@ -247,7 +329,7 @@ void Process_Data_From_Local_IO(void)
 
 void Serial_Char_Callback(unsigned char tmp)
 {
-  /* Add code to handle incomming data (remember, interrupts are still active) */
+  /* Add code to handle incomming data (remember, interrupts may still be active) */
 
 #if _USE_CMU_CAMERA
 /*******************************************************************************
@@ -0,0 +1,202 @@
+/*******************************************************************************
+* FILE NAME: user_scheduler.c
+*
+* DESCRIPTION:
+*  This file contains a small table driven cooperative scheduler.  Timer4 is
+*  set up to interrupt once every millisecond and InterruptHandlerLow counts
+*  those interrupts in sched_ticks.  Scheduler_Run is called from the main
+*  loop and calls every task in sched_table that is due.  Tasks are called in
+*  table order, so put the most important ones first.
+*
+*  Timer0 is used by FRC_library.lib for Generate_Pwms, and Timer2 is left
+*  alone so that it can still be used to generate a CCP PWM on outputs 13-16.
+*
+*  Nothing used to notice when the work overran the 26.2ms packet period.
+*  Scheduler_Frame_Check watches for it, by a gap in rxdata.packet_num
+*  (frame_steps, see user_frame.c) or by the time since the last packet,
+*  and each overrun raises sched_shed one level.  The tasks marked at or
+*  under that level are skipped until SCHED_CALM_FRAMES frames go by on
+*  time, then it comes down a level.
+*  The control frame itself is never skipped.
+*
+* USAGE:
+*  Every task must return quickly.  A task that needs to wait for something
+*  has to remember where it was and pick up from there on its next call.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_scheduler.h"
+#include "user_eeprom.h"
+#include "user_stack.h"
+#include "user_camlink.h"
+
+/*
+ * The task table.  The master uP packet handler stays first so the control
+ * frame is always serviced before anything else on the pass it arrives.
+ */
+static rom const SCHED_TASK sched_table[] =
+{
+  { Process_Data_From_Master_uP, SCHED_EVERY_PACKET, SCHED_SHED_NEVER },     /* 26.2ms control frame */
+  { Sample_Sensors,              1,                  SCHED_SHED_NEVER },     /* 1kHz sensor sampling */
+  { Eeprom_Task,                 10,                 SCHED_SHED_LOGGING },   /* 10ms profile saving */
+  { Stack_Task,                  50,                 SCHED_SHED_LOGGING },   /* 50ms stack high water mark */
+#if _USE_CMU_CAMERA
+  { Camera_Link_Task,            5,                  SCHED_SHED_CAMERA },    /* 5ms camera bring-up */
+#endif
+  { Telemetry_Task,              20,                 SCHED_SHED_TELEMETRY }, /* 20ms, a telemetry line */
+  { Process_Data_From_Local_IO,  SCHED_EVERY_PASS,   SCHED_SHED_NEVER }      /* as fast as possible */
+};
+
+#define SCHED_TASK_COUNT  (sizeof(sched_table) / sizeof(sched_table[0]))
+
+volatile unsigned int sched_ticks = 0;            /* ms since Scheduler_Initialize */
+static unsigned int sched_due[SCHED_TASK_COUNT];  /* tick each task is next due */
+
+unsigned char sched_shed = SCHED_SHED_NEVER;
+unsigned int sched_overruns = 0;
+unsigned int sched_shed_events = 0;
+unsigned int sched_skipped = 0;
+
+static unsigned char sched_started = 0;           /* sched_last_frame is valid */
+static unsigned int sched_last_frame;             /* tick of the last frame */
+static unsigned char sched_calm;                  /* frames on time in a row */
+
+/*******************************************************************************
+* FUNCTION NAME: Scheduler_Initialize
+* PURPOSE:       Starts the 1ms Timer4 tick and schedules every task.
+*                Timer4 runs from Fosc/4 (10MHz): 1:4 prescale, PR4 = 249 and
+*                1:10 postscale gives exactly 1000 interrupts a second.
+* CALLED FROM:   user_routines.c, User_Initialization
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Scheduler_Initialize(void)
+{
+  unsigned char i;
+
+  T4CON = 0;
+  TMR4 = 0;
+  PR4 = 249;
+  T4CONbits.T4CKPS0 = 1;        /* 1:4 prescale */
+  T4CONbits.T4OUTPS0 = 1;       /* 1:10 postscale (1001b) */
+  T4CONbits.T4OUTPS3 = 1;
+
+  IPR3bits.TMR4IP = 0;          /* low priority, like the serial ports */
+  PIR3bits.TMR4IF = 0;
+  PIE3bits.TMR4IE = 1;
+  T4CONbits.TMR4ON = 1;
+
+  /* Stagger the first call of each task so they don't all land on one tick */
+  for (i = 0; i < SCHED_TASK_COUNT; i++)
+    sched_due[i] = i;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Scheduler_Get_Ticks
+* PURPOSE:       Returns a consistent copy of the ms tick counter.  The counter
+*                is 16 bits wide so it can't be read in one instruction.
+* CALLED FROM:   anywhere
+* ARGUMENTS:     none
+* RETURNS:       unsigned int, ms since Scheduler_Initialize (wraps at 65.5s)
+*******************************************************************************/
+unsigned int Scheduler_Get_Ticks(void)
+{
+  unsigned int now;
+
+  INTCONbits.PEIE = 0;          /* Disable peripheral interrupt */
+  now = sched_ticks;
+  INTCONbits.PEIE = 1;          /* Enable peripheral interrupts */
+  return now;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Scheduler_Run
+* PURPOSE:       Calls every task that is due.  A periodic task that has fallen
+*                more than a whole period behind is rescheduled from now
+*                instead of being called over and over to catch up.
+* CALLED FROM:   main.c
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Scheduler_Run(void)
+{
+  unsigned char i;
+  unsigned int now;
+  unsigned int period;
+  void (*task)(void);
+
+  now = Scheduler_Get_Ticks();
+
+  for (i = 0; i < SCHED_TASK_COUNT; i++)
+  {
+    period = sched_table[i].period;
+
+    if (period == SCHED_EVERY_PACKET)
+    {
+      if (!statusflag.NEW_SPI_DATA)
+        continue;
+    }
+    else if (period != SCHED_EVERY_PASS)
+    {
+      if ((int)(now - sched_due[i]) < 0)      /* not due yet (wrap safe) */
+        continue;
+      sched_due[i] += period;
+      if ((int)(now - sched_due[i]) >= 0)     /* too far behind, resync */
+        sched_due[i] = now + period;
+    }
+
+    if (sched_table[i].shed != SCHED_SHED_NEVER && sched_table[i].shed <= sched_shed)
+    {
+      sched_skipped++;            /* the control frame is running late */
+      continue;
+    }
+
+    task = sched_table[i].task;
+    task();
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Scheduler_Frame_Check
+* PURPOSE:       Looks for an overrun at the start of each control frame: a
+*                packet_num that skipped, or more than SCHED_OVERRUN_MS
+*                since the last frame.  Sheds one more level on an overrun,
+*                and one less after SCHED_CALM_FRAMES frames without one.
+* CALLED FROM:   user_routines.c, Process_Data_From_Master_uP, after
+*                Frame_Latch
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     steps          unsigned char    I    frame_steps, 1 if none skipped
+* RETURNS:       void
+*******************************************************************************/
+void Scheduler_Frame_Check(unsigned char steps)
+{
+  unsigned int now;
+  unsigned char late;
+
+  now = Scheduler_Get_Ticks();
+  late = steps != 1 ||
+         (sched_started && now - sched_last_frame > SCHED_OVERRUN_MS);
+  sched_started = 1;
+  sched_last_frame = now;
+
+  if (late)
+  {
+    sched_overruns++;
+    sched_calm = 0;
+    if (sched_shed < SCHED_SHED_LOGGING)
+    {
+      sched_shed++;
+      sched_shed_events++;
+    }
+  }
+  else if (sched_shed != SCHED_SHED_NEVER && ++sched_calm >= SCHED_CALM_FRAMES)
+  {
+    sched_shed--;
+    sched_calm = 0;
+  }
+}
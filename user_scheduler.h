@@ -0,0 +1,60 @@
+/*******************************************************************************
+* FILE NAME: user_scheduler.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_scheduler.c
+*  It contains the task table layout and the scheduler prototypes.
+*
+* USAGE:
+*  Tasks are added to the table in user_scheduler.c.  Each task declares how
+*  often it wants to run, and whether it can be skipped when the control
+*  frame is running late (see Scheduler_Frame_Check).
+*******************************************************************************/
+#ifndef __user_scheduler_h_
+#define __user_scheduler_h_
+
+#define SCHED_TICK_HZ        1000     /* Timer4 tick rate, one tick per ms */
+
+/* Special task periods.  Anything else is a period in scheduler ticks (ms). */
+#define SCHED_EVERY_PASS     0        /* run on every pass of the main loop */
+#define SCHED_EVERY_PACKET   0xFFFF   /* run when the master uP sends new data (26.2ms) */
+
+/* Shed levels, in the order background work is dropped when frames overrun */
+#define SCHED_SHED_NEVER     0        /* always runs */
+#define SCHED_SHED_CAMERA    1        /* camera scanning goes first */
+#define SCHED_SHED_TELEMETRY 2        /* then the status lines */
+#define SCHED_SHED_LOGGING   3        /* then saving and bookkeeping */
+
+/* A task that holds up the main loop for more than about 13ms can push a
+   frame past SCHED_OVERRUN_MS on its own, so none may wait on a UART */
+#define SCHED_OVERRUN_MS     39       /* 1.5 frames between packets is an overrun */
+#define SCHED_CALM_FRAMES    38       /* about 1s of clean frames drops a level */
+
+/*
+ * One line of the task table.  The table lives in program memory, the time
+ * each task is next due is kept in RAM by the scheduler.
+ */
+typedef struct
+{
+  void (*task)(void);             /* routine to call */
+  unsigned int period;            /* ticks between calls, or one of the above */
+  unsigned char shed;             /* SCHED_SHED_xxx, when it can be skipped */
+} SCHED_TASK;
+
+extern volatile unsigned int sched_ticks;   /* bumped by InterruptHandlerLow */
+
+extern unsigned char sched_shed;            /* tasks at this level or under are skipped */
+extern unsigned int sched_overruns;         /* late or missed control frames */
+extern unsigned int sched_shed_events;      /* times sched_shed went up */
+extern unsigned int sched_skipped;          /* task calls skipped for it */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_scheduler.c */
+void Scheduler_Initialize(void);
+void Scheduler_Run(void);
+unsigned int Scheduler_Get_Ticks(void);
+void Scheduler_Frame_Check(unsigned char steps);
+
+#endif
@@ -0,0 +1,201 @@
+/*******************************************************************************
+* FILE NAME: user_shoulder.c
+*
+* DESCRIPTION:
+*  This file contains the position loop for the shoulder.  It used to run
+*  full speed up or down whenever the pot was more than shoulder_dead_zone
+*  away from where p3_y asked for, which overshot and hunted.  Now:
+*
+*  - Shoulder_Sample reads the pot every millisecond and keeps the average
+*    of the last SHOULDER_AVG readings, so one noisy sample doesn't kick the
+*    arm.
+*  - The p3_y to pot mapping (2.35 * p3_y + 200) is a table, worked out
+*    before the robot is turned on, instead of a floating point multiply
+*    every frame.
+*  - Shoulder_PID is a PID in Q8 integer math.  The D term is on the pot
+*    rather than the error, so moving p3_y doesn't kick the arm either.  The
+*    I term only adds up near the setpoint and not while the output is
+*    pinned, and the output can only change SHOULDER_SLEW counts a frame.
+*  - When packets are dropped the I, D and slew are scaled by frame_steps,
+*    so the loop keeps to the clock and not to the packet count.
+*
+* USAGE:
+*  Shoulder_Sample is called from Sample_Sensors.  Call Shoulder_PID once a
+*  frame while the pot is in charge of the arm and Shoulder_Reset when it
+*  isn't, so the loop starts clean the next time.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_shoulder.h"
+#include "user_encoder.h"
+#include "user_odometry.h"
+#include "user_frame.h"
+#include "user_input.h"
+#include "user_arena.h"
+
+/* p3_y to pot counts, (235 * i) / 100 + 200 */
+static const rom int shoulder_map[256] =
+{
+  200, 202, 204, 207, 209, 211, 214, 216,
+  218, 221, 223, 225, 228, 230, 232, 235,
+  237, 239, 242, 244, 247, 249, 251, 254,
+  256, 258, 261, 263, 265, 268, 270, 272,
+  275, 277, 279, 282, 284, 286, 289, 291,
+  294, 296, 298, 301, 303, 305, 308, 310,
+  312, 315, 317, 319, 322, 324, 326, 329,
+  331, 333, 336, 338, 341, 343, 345, 348,
+  350, 352, 355, 357, 359, 362, 364, 366,
+  369, 371, 373, 376, 378, 380, 383, 385,
+  388, 390, 392, 395, 397, 399, 402, 404,
+  406, 409, 411, 413, 416, 418, 420, 423,
+  425, 427, 430, 432, 435, 437, 439, 442,
+  444, 446, 449, 451, 453, 456, 458, 460,
+  463, 465, 467, 470, 472, 474, 477, 479,
+  482, 484, 486, 489, 491, 493, 496, 498,
+  500, 503, 505, 507, 510, 512, 514, 517,
+  519, 521, 524, 526, 529, 531, 533, 536,
+  538, 540, 543, 545, 547, 550, 552, 554,
+  557, 559, 561, 564, 566, 568, 571, 573,
+  576, 578, 580, 583, 585, 587, 590, 592,
+  594, 597, 599, 601, 604, 606, 608, 611,
+  613, 615, 618, 620, 623, 625, 627, 630,
+  632, 634, 637, 639, 641, 644, 646, 648,
+  651, 653, 655, 658, 660, 662, 665, 667,
+  670, 672, 674, 677, 679, 681, 684, 686,
+  688, 691, 693, 695, 698, 700, 702, 705,
+  707, 709, 712, 714, 717, 719, 721, 724,
+  726, 728, 731, 733, 735, 738, 740, 742,
+  745, 747, 749, 752, 754, 756, 759, 761,
+  764, 766, 768, 771, 773, 775, 778, 780,
+  782, 785, 787, 789, 792, 794, 796, 799
+};
+
+static unsigned int sh_samples[SHOULDER_AVG];  /* last pot readings */
+static unsigned char sh_next = 0;              /* oldest one */
+static unsigned int sh_sum = 0;                /* of sh_samples */
+
+/* In the hot state, see user_arena.h */
+#define sh_started    hot.sh_started  /* sh_last is valid */
+#define sh_last       hot.sh_last     /* pot last frame, for the D term */
+#define sh_integral   hot.sh_integral /* sum of the error */
+#define sh_out        hot.sh_out      /* PWM counts from neutral sent last */
+
+/*******************************************************************************
+* FUNCTION NAME: Shoulder_Sample
+* PURPOSE:       Reads the shoulder pot into the running average.
+* CALLED FROM:   user_routines_fast.c, Sample_Sensors, every 1ms
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Shoulder_Sample(void)
+{
+  unsigned int sample;
+
+  sample = Get_Analog_Value(shoulder_pot);
+  sh_sum = sh_sum - sh_samples[sh_next] + sample;
+  sh_samples[sh_next] = sample;
+  sh_next = (sh_next + 1) & (SHOULDER_AVG - 1);
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Shoulder_Position
+* PURPOSE:       The averaged shoulder pot.
+* CALLED FROM:   this file, user_autoscript.c
+* ARGUMENTS:     none
+* RETURNS:       unsigned int, 0 - 1023
+*******************************************************************************/
+unsigned int Shoulder_Position(void)
+{
+  return sh_sum >> SHOULDER_AVG_SHIFT;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Shoulder_Setpoint
+* PURPOSE:       The pot reading the operator's p3_y asks for.
+* CALLED FROM:   user_routines.c, shoulder_control
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     input          unsigned char    I    0 - 255
+* RETURNS:       unsigned int, pot counts
+*******************************************************************************/
+unsigned int Shoulder_Setpoint(unsigned char input)
+{
+  return shoulder_map[input];
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Shoulder_Reset
+* PURPOSE:       Forgets the integral and starts the output from neutral.
+* CALLED FROM:   user_routines.c, shoulder_control, in manual mode
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Shoulder_Reset(void)
+{
+  sh_started = 0;
+  sh_integral = 0;
+  sh_out = 0;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Shoulder_PID
+* PURPOSE:       Works out the shoulder PWM to get the pot to setpoint.
+* CALLED FROM:   user_routines.c, shoulder_control
+* ARGUMENTS:
+*     Argument       Type             IO   Description
+*     --------       -------------    --   -----------
+*     setpoint       unsigned int     I    pot counts
+* RETURNS:       unsigned char, the shoulder PWM
+*******************************************************************************/
+unsigned char Shoulder_PID(unsigned int setpoint)
+{
+  unsigned int position;
+  int err;
+  int moved;
+  int slew;
+  long out;
+
+  position = Shoulder_Position();
+  if (!sh_started)
+  {
+    sh_last = position;
+    sh_started = 1;
+  }
+  err = (int)setpoint - (int)position;
+  moved = ((int)position - (int)sh_last) / (int)frame_steps;  /* per frame */
+  sh_last = position;
+
+  if (err <= SHOULDER_TOLERANCE && err >= -SHOULDER_TOLERANCE)
+    err = 0;              /* there, don't chase the last few counts */
+
+  /* Only add to the integral close in, and not into a pinned output */
+  if (err < SHOULDER_I_ZONE && err > -SHOULDER_I_ZONE &&
+      !(sh_out >= 127 && err > 0) && !(sh_out <= -127 && err < 0))
+  {
+    sh_integral += (long)err * frame_steps;
+    if (sh_integral > SHOULDER_I_MAX)
+      sh_integral = SHOULDER_I_MAX;
+    if (sh_integral < -SHOULDER_I_MAX)
+      sh_integral = -SHOULDER_I_MAX;
+  }
+
+  out = ((long)err * SHOULDER_KP + sh_integral * SHOULDER_KI -
+         (long)moved * SHOULDER_KD) / 256;
+  if (out > 127)
+    out = 127;
+  if (out < -127)
+    out = -127;
+
+  slew = SHOULDER_SLEW * (int)frame_steps;
+  if (out > sh_out + slew)
+    out = sh_out + slew;
+  if (out < sh_out - slew)
+    out = sh_out - slew;
+  sh_out = (int)out;
+
+  return (unsigned char)(127 + sh_out);
+}
@@ -0,0 +1,37 @@
+/*******************************************************************************
+* FILE NAME: user_shoulder.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_shoulder.c
+*  It contains the gains for the shoulder position loop.
+*
+* USAGE:
+*  Gains are Q8 (256 = 1.0) in PWM counts per pot count.  Raise SHOULDER_KP
+*  until the arm just starts to overshoot, then raise SHOULDER_KD until it
+*  stops.  SHOULDER_KI only has to take out the sag from the arm's weight.
+*******************************************************************************/
+#ifndef __user_shoulder_h_
+#define __user_shoulder_h_
+
+#define SHOULDER_KP         160   /* 0.625 PWM counts per pot count */
+#define SHOULDER_KI         6     /* per pot count per frame */
+#define SHOULDER_KD         512   /* per pot count the arm moved last frame */
+#define SHOULDER_I_ZONE     50    /* only integrate this close, pot counts */
+#define SHOULDER_I_MAX      ((40L * 256) / SHOULDER_KI)  /* I term up to 40 */
+#define SHOULDER_SLEW       16    /* most the PWM changes in a frame */
+#define SHOULDER_TOLERANCE  4     /* pot counts, close enough to hold */
+
+#define SHOULDER_AVG_SHIFT  3     /* average the last 8 pot samples */
+#define SHOULDER_AVG        (1 << SHOULDER_AVG_SHIFT)
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_shoulder.c */
+void Shoulder_Sample(void);
+unsigned int Shoulder_Position(void);
+unsigned int Shoulder_Setpoint(unsigned char input);
+void Shoulder_Reset(void);
+unsigned char Shoulder_PID(unsigned int setpoint);
+
+#endif
@@ -0,0 +1,91 @@
+/*******************************************************************************
+* FILE NAME: user_stack.c
+*
+* DESCRIPTION:
+*  This file contains the software stack high water mark.  C18 keeps auto
+*  variables, arguments and the interrupt context on a software stack that
+*  grows up from _stack (FSR1 is the top).  The linker gives it STACK_SIZE
+*  bytes and nothing checks it: a call chain like probe_pos ->
+*  examine_grid_position -> camera_buffer_cmd -> camera_getACK, with printf
+*  and a low priority interrupt on top, that runs past the end just writes
+*  over whatever is in the next bank.
+*
+*  Stack_Paint fills the stack with STACK_PAINT at reset, before main runs.
+*  Stack_Task looks down from the end for the first byte that isn't paint
+*  anymore; that's as deep as the stack has ever been.
+*
+* USAGE:
+*  Stack_Paint is called from _startup in ifi_startup.c, right after RAM is
+*  cleared.  Stack_Task is in the scheduler table.
+*******************************************************************************/
+
+#include "ifi_aliases.h"
+#include "ifi_default.h"
+#include "ifi_utilities.h"
+#include "user_routines.h"
+#include "user_stack.h"
+#include <stdio.h>
+
+extern unsigned char _stack[];      /* from the linker, the bottom of the stack */
+
+unsigned int stack_high_water = 0;
+unsigned char stack_warning = 0;
+
+static unsigned char *stack_scan;   /* not an auto, nothing on the stack yet */
+
+/*******************************************************************************
+* FUNCTION NAME: Stack_Paint
+* PURPOSE:       Fills the unused part of the software stack with STACK_PAINT.
+*                Everything below FSR1 belongs to the caller.
+* CALLED FROM:   ifi_startup.c, _startup
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Stack_Paint(void)
+{
+  stack_scan = (unsigned char *)FSR1;
+  while (stack_scan < &_stack[STACK_SIZE])
+    *stack_scan++ = STACK_PAINT;
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Stack_Task
+* PURPOSE:       Updates stack_high_water.  Only the bytes above the old mark
+*                are looked at, a byte under it can't tell us anything new.
+* CALLED FROM:   user_scheduler.c, every 50ms
+* ARGUMENTS:     none
+* RETURNS:       void
+*******************************************************************************/
+void Stack_Task(void)
+{
+  unsigned int used;
+
+  used = STACK_SIZE;
+  while (used > stack_high_water && _stack[used - 1] == STACK_PAINT)
+    used--;
+
+  if (used > stack_high_water)
+  {
+    stack_high_water = used;
+    if (used > STACK_SIZE - STACK_GUARD && !stack_warning)
+    {
+      stack_warning = 1;
+      printf("STACK %d of %d bytes used\r", (int)used, STACK_SIZE);
+    }
+  }
+}
+
+/*******************************************************************************
+* FUNCTION NAME: Stack_Display
+* PURPOSE:       The high water mark for the OI user display, which only has
+*                room for 0 - 255.
+* CALLED FROM:   user_routines.c, Default_Routine, if STACK_ON_OI
+* ARGUMENTS:     none
+* RETURNS:       bytes of stack used, 255 meaning 255 or more
+*******************************************************************************/
+unsigned char Stack_Display(void)
+{
+  if (stack_high_water > 255)
+    return 255;
+  return (unsigned char)stack_high_water;
+}
@@ -0,0 +1,35 @@
+/*******************************************************************************
+* FILE NAME: user_stack.h
+*
+* DESCRIPTION:
+*  This is the include file which corresponds to user_stack.c
+*  It contains the size of the software stack and how close to the end of
+*  it counts as too close.
+*
+* USAGE:
+*  STACK_SIZE has to match "STACK SIZE=" in 18f8520user.lkr.  Run the robot
+*  through everything it does (autonomous with the camera, printf, the OI
+*  connected) and read the high water mark from the STK telemetry line, or
+*  set STACK_ON_OI to 1 to show it on the OI user display in place of the
+*  backup battery.  The stack can come down to that plus STACK_GUARD.
+*******************************************************************************/
+#ifndef __user_stack_h_
+#define __user_stack_h_
+
+#define STACK_SIZE    0x100   /* bytes, from 18f8520user.lkr */
+#define STACK_GUARD   32      /* warn once the stack gets this close to the end */
+#define STACK_PAINT   0xA5    /* what an untouched stack byte holds */
+#define STACK_ON_OI   0       /* 1 = OI user display shows the stack, not the battery */
+
+extern unsigned int stack_high_water;   /* most bytes ever used */
+extern unsigned char stack_warning;     /* it got within STACK_GUARD of the end */
+
+/*******************************************************************************
+                           FUNCTION PROTOTYPES
+*******************************************************************************/
+/* These routines reside in user_stack.c */
+void Stack_Paint(void);
+void Stack_Task(void);
+unsigned char Stack_Display(void);
+
+#endif